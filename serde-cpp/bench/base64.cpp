@@ -0,0 +1,114 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "serde/base64.h"
+#include "serde/serde.h"
+#include "serde_yaml/serde_yaml.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Benchmark of base64 encode/decode throughput, per implementation and
+// through the YAML backend's serialize_bytes/deserialize_bytes
+///////////////////////////////////////////////////////////////////////////////
+
+struct Blob {
+  std::vector<uint8_t> data;
+};
+
+template<>
+void serde::serialize(serde::Serializer& ser, const Blob& blob)
+{
+  ser.serialize_bytes(blob.data.data(), blob.data.size());
+}
+
+template<>
+void serde::deserialize(serde::Deserializer& de, Blob& blob)
+{
+  size_t len = 0;
+  de.deserialize_length(len);
+  blob.data.resize(len / 4 * 3);
+  de.deserialize_bytes(blob.data.data(), blob.data.size());
+}
+
+static constexpr size_t kSize = 3 * 1024 * 1024; // multiple of 3, no padding to trim after decoding
+
+static const std::vector<uint8_t>& raw_bytes()
+{
+  static const std::vector<uint8_t> raw = [] {
+    std::mt19937 rng(7);
+    std::vector<uint8_t> raw(kSize);
+    for (auto& b : raw) b = static_cast<uint8_t>(rng());
+    return raw;
+  }();
+  return raw;
+}
+
+static bool supported(serde::base64::Impl impl)
+{
+  using serde::base64::Impl;
+  const auto best = serde::base64::best_impl();
+  return impl == Impl::Scalar || impl == best || (impl == Impl::SSSE3 && best == Impl::AVX2);
+}
+
+static void BM_Base64Encode(benchmark::State& state)
+{
+  const auto impl = static_cast<serde::base64::Impl>(state.range(0));
+  if (!supported(impl)) {
+    state.SkipWithError("not supported on this CPU");
+    return;
+  }
+  const auto& raw = raw_bytes();
+  std::string enc(serde::base64::encoded_length(raw.size()), '\0');
+  for (auto _ : state) {
+    serde::base64::encode(raw.data(), raw.size(), enc.data(), impl);
+    benchmark::DoNotOptimize(enc.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * raw.size()));
+}
+
+static void BM_Base64Decode(benchmark::State& state)
+{
+  const auto impl = static_cast<serde::base64::Impl>(state.range(0));
+  if (!supported(impl)) {
+    state.SkipWithError("not supported on this CPU");
+    return;
+  }
+  const auto& raw = raw_bytes();
+  std::string enc(serde::base64::encoded_length(raw.size()), '\0');
+  serde::base64::encode(raw.data(), raw.size(), enc.data());
+  std::vector<uint8_t> dec(raw.size());
+  for (auto _ : state) {
+    auto len = serde::base64::decode(enc.data(), enc.size(), dec.data(), dec.size(), impl);
+    benchmark::DoNotOptimize(len);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * raw.size()));
+}
+
+static void BM_Base64Serialize(benchmark::State& state)
+{
+  const Blob blob{raw_bytes()};
+  for (auto _ : state) {
+    auto yaml = serde_yaml::to_string(blob).value();
+    benchmark::DoNotOptimize(yaml);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * blob.data.size()));
+}
+
+static void BM_Base64Deserialize(benchmark::State& state)
+{
+  const auto yaml = serde_yaml::to_string(Blob{raw_bytes()}).value();
+  for (auto _ : state) {
+    auto blob = serde_yaml::from_str<Blob>(std::string(yaml)).value();
+    benchmark::DoNotOptimize(blob);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * raw_bytes().size()));
+}
+
+// Argument is the serde::base64::Impl: 0 scalar, 1 SSSE3, 2 AVX2
+BENCHMARK(BM_Base64Encode)->DenseRange(0, 2);
+BENCHMARK(BM_Base64Decode)->DenseRange(0, 2);
+BENCHMARK(BM_Base64Serialize);
+BENCHMARK(BM_Base64Deserialize);
@@ -0,0 +1,348 @@
+#include <benchmark/benchmark.h>
+
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "serde/std.h"
+#include "serde/serde.h"
+#include "serde/hash.h"
+#include "serde/tape.h"
+#include "serde_yaml/serde_yaml.h"
+#include "serde_yaml/instrument.h"
+
+#include "types.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Payloads
+///////////////////////////////////////////////////////////////////////////////
+// Each payload provides its Type, a deterministic value() and the number of
+// items in it, reported as items/s next to the bytes/s of the YAML text.
+// allocs is the budget of heap allocations per item of a to_string/from_str call,
+// a loose upper bound meant to catch regressions, not to track exact counts.
+
+struct ScalarsPayload {
+  static constexpr size_t allocs = 1;
+  using Type = std::vector<bench::Scalars>;
+  static constexpr size_t items = 1000;
+  static const Type& value() {
+    static const Type val = [] {
+      std::mt19937 rng(1);
+      Type val(items);
+      for (size_t i = 0; i < items; i++) {
+        val[i].id = static_cast<int32_t>(i);
+        val[i].timestamp = 1700000000000 + static_cast<int64_t>(rng());
+        val[i].value = std::uniform_real_distribution<double>(-1e6, 1e6)(rng);
+        val[i].ratio = std::uniform_real_distribution<float>(0, 1)(rng);
+        val[i].active = rng() % 2;
+        val[i].flags = static_cast<uint8_t>(rng());
+      }
+      return val;
+    }();
+    return val;
+  }
+};
+
+struct StringsPayload {
+  static constexpr size_t allocs = 8;
+  using Type = std::vector<bench::Strings>;
+  static constexpr size_t items = 1000;
+  static const Type& value() {
+    static const Type val = [] {
+      std::mt19937 rng(2);
+      auto text = [&](size_t len) {
+        std::string str(len, ' ');
+        for (auto& c : str) c = "abcdefghijklmnopqrstuvwxyz     "[rng() % 31];
+        str.front() = str.back() = 'x';
+        return str;
+      };
+      Type val(items);
+      for (auto& e : val) {
+        e.name = text(8 + rng() % 16);
+        e.description = text(40 + rng() % 200);
+        e.tags.resize(rng() % 6);
+        for (auto& tag : e.tags) tag = text(3 + rng() % 10);
+      }
+      return val;
+    }();
+    return val;
+  }
+};
+
+struct NestedPayload {
+  static constexpr size_t allocs = 2;
+  using Type = bench::Nested;
+  static constexpr size_t depth = 10; // complete binary tree
+  static constexpr size_t items = (size_t{1} << depth) - 1;
+  static bench::Nested make(size_t level, int32_t& counter) {
+    bench::Nested node{counter++, {}};
+    if (level + 1 < depth) {
+      node.children.push_back(make(level + 1, counter));
+      node.children.push_back(make(level + 1, counter));
+    }
+    return node;
+  }
+  static const Type& value() {
+    static const Type val = [] { int32_t counter = 0; return make(0, counter); }();
+    return val;
+  }
+};
+
+struct WidePayload {
+  static constexpr size_t allocs = 4;
+  using Type = std::vector<bench::Wide>;
+  static constexpr size_t items = 200;
+  static const Type& value() {
+    static const Type val = [] {
+      Type val(items);
+      int32_t i = 0;
+      for (auto& e : val) {
+        e.f00 = e.f04 = e.f08 = e.f12 = e.f16 = e.f20 = e.f24 = e.f28 = i++;
+        e.f01 = e.f05 = e.f09 = e.f13 = e.f17 = e.f21 = e.f25 = e.f29 = i * 0.5;
+        e.f02 = e.f06 = e.f10 = e.f14 = e.f18 = e.f22 = e.f26 = e.f30 = "field " + std::to_string(i);
+        e.f03 = e.f07 = e.f11 = e.f15 = e.f19 = e.f23 = e.f27 = e.f31 = i % 2;
+      }
+      return val;
+    }();
+    return val;
+  }
+};
+
+struct ContainersPayload {
+  static constexpr size_t allocs = 64;
+  using Type = std::vector<bench::Containers>;
+  static constexpr size_t items = 200;
+  static const Type& value() {
+    static const Type val = [] {
+      std::mt19937 rng(3);
+      Type val(items);
+      for (auto& e : val) {
+        for (int g = 0; g < 4; g++) {
+          auto& group = e.groups["group" + std::to_string(g)];
+          for (int k = 0; k < 8; k++) group.insert(static_cast<int32_t>(rng() % 1000));
+        }
+        for (int v = 0; v < 6; v++) {
+          switch (rng() % 3) {
+            case 0: e.values.emplace_back(static_cast<int64_t>(rng())); break;
+            case 1: e.values.emplace_back(std::uniform_real_distribution<double>(0, 1)(rng)); break;
+            default: e.values.emplace_back("value" + std::to_string(rng() % 100)); break;
+          }
+        }
+        if (rng() % 2) e.note = "note " + std::to_string(rng() % 100);
+        for (int c = 0; c < 4; c++) {
+          auto& counter = e.counters["counter" + std::to_string(c)];
+          if (rng() % 4) counter = static_cast<int32_t>(rng() % 100);
+        }
+      }
+      return val;
+    }();
+    return val;
+  }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Corpus
+///////////////////////////////////////////////////////////////////////////////
+// Representative documents checked in under bench/corpus.
+
+static std::string read_corpus(const char* name)
+{
+  std::ifstream file(std::string(SERDE_BENCH_CORPUS) + "/" + name);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  return buffer.str();
+}
+
+struct RecordsCorpus {
+  using Type = std::vector<bench::Scalars>;
+  static constexpr const char* file = "records.yaml";
+};
+
+struct CatalogCorpus {
+  using Type = std::vector<bench::Strings>;
+  static constexpr const char* file = "catalog.yaml";
+};
+
+struct ConfigCorpus {
+  using Type = bench::Config;
+  static constexpr const char* file = "config.yaml";
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Allocations
+///////////////////////////////////////////////////////////////////////////////
+// Allocations of one call are counted before the timed loop and reported per call,
+// serde_bench links the global operator new hook so every phase is seen.
+
+static constexpr size_t kAllocsFixed = 64; // buffers and state not proportional to the items
+
+static void ReportAllocations(benchmark::State& state, const serde_yaml::instrument::Stats& stats)
+{
+  const auto total = stats.total();
+  state.counters["allocs"] = static_cast<double>(total.count);
+  state.counters["alloc_bytes"] = static_cast<double>(total.bytes);
+  state.counters["allocs_parse"] = static_cast<double>(stats.parse.count);
+  state.counters["allocs_objects"] = static_cast<double>(stats.objects.count);
+  state.counters["allocs_tree"] = static_cast<double>(stats.tree.count);
+  state.counters["allocs_emit"] = static_cast<double>(stats.emit.count);
+}
+
+template<typename Payload>
+static bool WithinBudget(benchmark::State& state, const serde_yaml::instrument::Stats& stats)
+{
+  ReportAllocations(state, stats);
+  if (stats.total().count <= Payload::allocs * Payload::items + kAllocsFixed)
+    return true;
+  state.SkipWithError("allocations over budget");
+  return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Benchmarks
+///////////////////////////////////////////////////////////////////////////////
+
+template<typename Payload>
+static void BM_Serialize(benchmark::State& state)
+{
+  const auto& val = Payload::value();
+  auto stats = serde_yaml::instrument::measure([&] { benchmark::DoNotOptimize(serde_yaml::to_string(val)); });
+  if (!WithinBudget<Payload>(state, stats))
+    return;
+  size_t bytes = 0;
+  for (auto _ : state) {
+    auto yaml = serde_yaml::to_string(val).value();
+    bytes += yaml.size();
+    benchmark::DoNotOptimize(yaml);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(bytes));
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * Payload::items));
+}
+
+// The copy of the input handed to from_str is part of the measurement, as it is for callers
+template<typename Payload>
+static void BM_Deserialize(benchmark::State& state)
+{
+  const auto yaml = serde_yaml::to_string(Payload::value()).value();
+  auto stats = serde_yaml::instrument::measure([&] {
+    benchmark::DoNotOptimize(serde_yaml::from_str<typename Payload::Type>(std::string(yaml)));
+  });
+  if (!WithinBudget<Payload>(state, stats))
+    return;
+  for (auto _ : state) {
+    auto val = serde_yaml::from_str<typename Payload::Type>(std::string(yaml)).value();
+    benchmark::DoNotOptimize(val);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * yaml.size()));
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * Payload::items));
+}
+
+// Content hash of the payload, the alternative to hashing its YAML text for cache keys
+template<typename Payload>
+static void BM_Hash(benchmark::State& state)
+{
+  const auto& val = Payload::value();
+  for (auto _ : state) {
+    auto hash = serde::hash(val);
+    benchmark::DoNotOptimize(hash);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * Payload::items));
+}
+
+// Deep copy through the tape, the alternative to a to_string/from_str round trip
+template<typename Payload>
+static void BM_Clone(benchmark::State& state)
+{
+  const auto& val = Payload::value();
+  for (auto _ : state) {
+    auto copy = serde::clone(val);
+    benchmark::DoNotOptimize(copy);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * Payload::items));
+}
+
+template<typename Corpus>
+static void BM_DeserializeCorpus(benchmark::State& state)
+{
+  const auto yaml = read_corpus(Corpus::file);
+  if (yaml.empty()) {
+    state.SkipWithError("corpus file not found");
+    return;
+  }
+  ReportAllocations(state, serde_yaml::instrument::measure([&] {
+    benchmark::DoNotOptimize(serde_yaml::from_str<typename Corpus::Type>(std::string(yaml)));
+  }));
+  for (auto _ : state) {
+    auto val = serde_yaml::from_str<typename Corpus::Type>(std::string(yaml)).value();
+    benchmark::DoNotOptimize(val);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * yaml.size()));
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+// Corpus document into a tape through transcode, without its C++ type
+template<typename Corpus>
+static void BM_TranscodeCorpus(benchmark::State& state)
+{
+  const auto yaml = read_corpus(Corpus::file);
+  if (yaml.empty()) {
+    state.SkipWithError("corpus file not found");
+    return;
+  }
+  serde::Tape tape;
+  serde::TapeSerializer ser(tape);
+  for (auto _ : state) {
+    tape.clear();
+    benchmark::DoNotOptimize(serde_yaml::transcode(std::string(yaml), ser));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * yaml.size()));
+}
+
+template<typename Corpus>
+static void BM_SerializeCorpus(benchmark::State& state)
+{
+  const auto val = serde_yaml::from_str<typename Corpus::Type>(read_corpus(Corpus::file)).value();
+  ReportAllocations(state, serde_yaml::instrument::measure([&] { benchmark::DoNotOptimize(serde_yaml::to_string(val)); }));
+  size_t bytes = 0;
+  for (auto _ : state) {
+    auto yaml = serde_yaml::to_string(val).value();
+    bytes += yaml.size();
+    benchmark::DoNotOptimize(yaml);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(bytes));
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK_TEMPLATE(BM_Serialize, ScalarsPayload);
+BENCHMARK_TEMPLATE(BM_Deserialize, ScalarsPayload);
+BENCHMARK_TEMPLATE(BM_Hash, ScalarsPayload);
+BENCHMARK_TEMPLATE(BM_Clone, ScalarsPayload);
+BENCHMARK_TEMPLATE(BM_Serialize, StringsPayload);
+BENCHMARK_TEMPLATE(BM_Deserialize, StringsPayload);
+BENCHMARK_TEMPLATE(BM_Hash, StringsPayload);
+BENCHMARK_TEMPLATE(BM_Clone, StringsPayload);
+BENCHMARK_TEMPLATE(BM_Serialize, NestedPayload);
+BENCHMARK_TEMPLATE(BM_Deserialize, NestedPayload);
+BENCHMARK_TEMPLATE(BM_Hash, NestedPayload);
+BENCHMARK_TEMPLATE(BM_Clone, NestedPayload);
+BENCHMARK_TEMPLATE(BM_Serialize, WidePayload);
+BENCHMARK_TEMPLATE(BM_Deserialize, WidePayload);
+BENCHMARK_TEMPLATE(BM_Hash, WidePayload);
+BENCHMARK_TEMPLATE(BM_Clone, WidePayload);
+BENCHMARK_TEMPLATE(BM_Serialize, ContainersPayload);
+BENCHMARK_TEMPLATE(BM_Deserialize, ContainersPayload);
+BENCHMARK_TEMPLATE(BM_Hash, ContainersPayload);
+BENCHMARK_TEMPLATE(BM_Clone, ContainersPayload);
+
+BENCHMARK_TEMPLATE(BM_DeserializeCorpus, RecordsCorpus);
+BENCHMARK_TEMPLATE(BM_SerializeCorpus, RecordsCorpus);
+BENCHMARK_TEMPLATE(BM_TranscodeCorpus, RecordsCorpus);
+BENCHMARK_TEMPLATE(BM_DeserializeCorpus, CatalogCorpus);
+BENCHMARK_TEMPLATE(BM_SerializeCorpus, CatalogCorpus);
+BENCHMARK_TEMPLATE(BM_TranscodeCorpus, CatalogCorpus);
+BENCHMARK_TEMPLATE(BM_DeserializeCorpus, ConfigCorpus);
+BENCHMARK_TEMPLATE(BM_SerializeCorpus, ConfigCorpus);
+BENCHMARK_TEMPLATE(BM_TranscodeCorpus, ConfigCorpus);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,315 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "serde/serde.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Benchmark payload types, with hand-written serde so the benchmarks
+// measure the backends alone, without depending on serde_gen
+///////////////////////////////////////////////////////////////////////////////
+namespace bench {
+
+/// Scalar-heavy record
+struct Scalars {
+  int32_t id;
+  int64_t timestamp;
+  double value;
+  float ratio;
+  bool active;
+  uint8_t flags;
+};
+
+/// String-heavy record
+struct Strings {
+  std::string name;
+  std::string description;
+  std::vector<std::string> tags;
+};
+
+/// Deeply nested tree
+struct Nested {
+  int32_t value;
+  std::vector<Nested> children;
+};
+
+/// Wide struct of 32 fields
+struct Wide {
+  int32_t f00;
+  double f01;
+  std::string f02;
+  bool f03;
+  int32_t f04;
+  double f05;
+  std::string f06;
+  bool f07;
+  int32_t f08;
+  double f09;
+  std::string f10;
+  bool f11;
+  int32_t f12;
+  double f13;
+  std::string f14;
+  bool f15;
+  int32_t f16;
+  double f17;
+  std::string f18;
+  bool f19;
+  int32_t f20;
+  double f21;
+  std::string f22;
+  bool f23;
+  int32_t f24;
+  double f25;
+  std::string f26;
+  bool f27;
+  int32_t f28;
+  double f29;
+  std::string f30;
+  bool f31;
+};
+
+/// Container-heavy record
+struct Containers {
+  std::map<std::string, std::set<int32_t>> groups;
+  std::vector<std::variant<int64_t, double, std::string>> values;
+  std::optional<std::string> note;
+  std::unordered_map<std::string, std::optional<int32_t>> counters;
+};
+
+/// Service of a deployment configuration, see corpus/config.yaml
+struct Service {
+  std::string image;
+  int32_t replicas;
+  std::vector<int32_t> ports;
+  std::map<std::string, std::string> env;
+  std::optional<std::string> command;
+};
+
+/// Deployment configuration, see corpus/config.yaml
+struct Config {
+  std::string name;
+  int32_t version;
+  std::map<std::string, Service> services;
+};
+
+} // namespace bench
+
+namespace serde {
+
+template<>
+inline void serialize(Serializer& ser, const bench::Scalars& val)
+{
+  ser.serialize_struct_begin();
+  ser.serialize_struct_field("id", val.id);
+  ser.serialize_struct_field("timestamp", val.timestamp);
+  ser.serialize_struct_field("value", val.value);
+  ser.serialize_struct_field("ratio", val.ratio);
+  ser.serialize_struct_field("active", val.active);
+  ser.serialize_struct_field("flags", val.flags);
+  ser.serialize_struct_end();
+}
+
+template<>
+inline void deserialize(Deserializer& de, bench::Scalars& val)
+{
+  de.deserialize_struct_begin();
+  de.deserialize_struct_field("id", val.id);
+  de.deserialize_struct_field("timestamp", val.timestamp);
+  de.deserialize_struct_field("value", val.value);
+  de.deserialize_struct_field("ratio", val.ratio);
+  de.deserialize_struct_field("active", val.active);
+  de.deserialize_struct_field("flags", val.flags);
+  de.deserialize_struct_end();
+}
+
+template<>
+inline void serialize(Serializer& ser, const bench::Strings& val)
+{
+  ser.serialize_struct_begin();
+  ser.serialize_struct_field("name", val.name);
+  ser.serialize_struct_field("description", val.description);
+  ser.serialize_struct_field("tags", val.tags);
+  ser.serialize_struct_end();
+}
+
+template<>
+inline void deserialize(Deserializer& de, bench::Strings& val)
+{
+  de.deserialize_struct_begin();
+  de.deserialize_struct_field("name", val.name);
+  de.deserialize_struct_field("description", val.description);
+  de.deserialize_struct_field("tags", val.tags);
+  de.deserialize_struct_end();
+}
+
+template<>
+inline void serialize(Serializer& ser, const bench::Nested& val)
+{
+  ser.serialize_struct_begin();
+  ser.serialize_struct_field("value", val.value);
+  ser.serialize_struct_field("children", val.children);
+  ser.serialize_struct_end();
+}
+
+template<>
+inline void deserialize(Deserializer& de, bench::Nested& val)
+{
+  de.deserialize_struct_begin();
+  de.deserialize_struct_field("value", val.value);
+  de.deserialize_struct_field("children", val.children);
+  de.deserialize_struct_end();
+}
+
+template<>
+inline void serialize(Serializer& ser, const bench::Wide& val)
+{
+  ser.serialize_struct_begin();
+  ser.serialize_struct_field("f00", val.f00);
+  ser.serialize_struct_field("f01", val.f01);
+  ser.serialize_struct_field("f02", val.f02);
+  ser.serialize_struct_field("f03", val.f03);
+  ser.serialize_struct_field("f04", val.f04);
+  ser.serialize_struct_field("f05", val.f05);
+  ser.serialize_struct_field("f06", val.f06);
+  ser.serialize_struct_field("f07", val.f07);
+  ser.serialize_struct_field("f08", val.f08);
+  ser.serialize_struct_field("f09", val.f09);
+  ser.serialize_struct_field("f10", val.f10);
+  ser.serialize_struct_field("f11", val.f11);
+  ser.serialize_struct_field("f12", val.f12);
+  ser.serialize_struct_field("f13", val.f13);
+  ser.serialize_struct_field("f14", val.f14);
+  ser.serialize_struct_field("f15", val.f15);
+  ser.serialize_struct_field("f16", val.f16);
+  ser.serialize_struct_field("f17", val.f17);
+  ser.serialize_struct_field("f18", val.f18);
+  ser.serialize_struct_field("f19", val.f19);
+  ser.serialize_struct_field("f20", val.f20);
+  ser.serialize_struct_field("f21", val.f21);
+  ser.serialize_struct_field("f22", val.f22);
+  ser.serialize_struct_field("f23", val.f23);
+  ser.serialize_struct_field("f24", val.f24);
+  ser.serialize_struct_field("f25", val.f25);
+  ser.serialize_struct_field("f26", val.f26);
+  ser.serialize_struct_field("f27", val.f27);
+  ser.serialize_struct_field("f28", val.f28);
+  ser.serialize_struct_field("f29", val.f29);
+  ser.serialize_struct_field("f30", val.f30);
+  ser.serialize_struct_field("f31", val.f31);
+  ser.serialize_struct_end();
+}
+
+template<>
+inline void deserialize(Deserializer& de, bench::Wide& val)
+{
+  de.deserialize_struct_begin();
+  de.deserialize_struct_field("f00", val.f00);
+  de.deserialize_struct_field("f01", val.f01);
+  de.deserialize_struct_field("f02", val.f02);
+  de.deserialize_struct_field("f03", val.f03);
+  de.deserialize_struct_field("f04", val.f04);
+  de.deserialize_struct_field("f05", val.f05);
+  de.deserialize_struct_field("f06", val.f06);
+  de.deserialize_struct_field("f07", val.f07);
+  de.deserialize_struct_field("f08", val.f08);
+  de.deserialize_struct_field("f09", val.f09);
+  de.deserialize_struct_field("f10", val.f10);
+  de.deserialize_struct_field("f11", val.f11);
+  de.deserialize_struct_field("f12", val.f12);
+  de.deserialize_struct_field("f13", val.f13);
+  de.deserialize_struct_field("f14", val.f14);
+  de.deserialize_struct_field("f15", val.f15);
+  de.deserialize_struct_field("f16", val.f16);
+  de.deserialize_struct_field("f17", val.f17);
+  de.deserialize_struct_field("f18", val.f18);
+  de.deserialize_struct_field("f19", val.f19);
+  de.deserialize_struct_field("f20", val.f20);
+  de.deserialize_struct_field("f21", val.f21);
+  de.deserialize_struct_field("f22", val.f22);
+  de.deserialize_struct_field("f23", val.f23);
+  de.deserialize_struct_field("f24", val.f24);
+  de.deserialize_struct_field("f25", val.f25);
+  de.deserialize_struct_field("f26", val.f26);
+  de.deserialize_struct_field("f27", val.f27);
+  de.deserialize_struct_field("f28", val.f28);
+  de.deserialize_struct_field("f29", val.f29);
+  de.deserialize_struct_field("f30", val.f30);
+  de.deserialize_struct_field("f31", val.f31);
+  de.deserialize_struct_end();
+}
+
+template<>
+inline void serialize(Serializer& ser, const bench::Containers& val)
+{
+  ser.serialize_struct_begin();
+  ser.serialize_struct_field("groups", val.groups);
+  ser.serialize_struct_field("values", val.values);
+  ser.serialize_struct_field("note", val.note);
+  ser.serialize_struct_field("counters", val.counters);
+  ser.serialize_struct_end();
+}
+
+template<>
+inline void deserialize(Deserializer& de, bench::Containers& val)
+{
+  de.deserialize_struct_begin();
+  de.deserialize_struct_field("groups", val.groups);
+  de.deserialize_struct_field("values", val.values);
+  de.deserialize_struct_field("note", val.note);
+  de.deserialize_struct_field("counters", val.counters);
+  de.deserialize_struct_end();
+}
+
+template<>
+inline void serialize(Serializer& ser, const bench::Service& val)
+{
+  ser.serialize_struct_begin();
+  ser.serialize_struct_field("image", val.image);
+  ser.serialize_struct_field("replicas", val.replicas);
+  ser.serialize_struct_field("ports", val.ports);
+  ser.serialize_struct_field("env", val.env);
+  ser.serialize_struct_field("command", val.command);
+  ser.serialize_struct_end();
+}
+
+template<>
+inline void deserialize(Deserializer& de, bench::Service& val)
+{
+  de.deserialize_struct_begin();
+  de.deserialize_struct_field("image", val.image);
+  de.deserialize_struct_field("replicas", val.replicas);
+  de.deserialize_struct_field("ports", val.ports);
+  de.deserialize_struct_field("env", val.env);
+  de.deserialize_struct_field("command", val.command);
+  de.deserialize_struct_end();
+}
+
+template<>
+inline void serialize(Serializer& ser, const bench::Config& val)
+{
+  ser.serialize_struct_begin();
+  ser.serialize_struct_field("name", val.name);
+  ser.serialize_struct_field("version", val.version);
+  ser.serialize_struct_field("services", val.services);
+  ser.serialize_struct_end();
+}
+
+template<>
+inline void deserialize(Deserializer& de, bench::Config& val)
+{
+  de.deserialize_struct_begin();
+  de.deserialize_struct_field("name", val.name);
+  de.deserialize_struct_field("version", val.version);
+  de.deserialize_struct_field("services", val.services);
+  de.deserialize_struct_end();
+}
+
+} // namespace serde
@@ -0,0 +1,323 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SERDE_BASE64_X86 1
+#include <immintrin.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+/// Base64 (RFC 4648, standard alphabet, padded) for text backends
+///
+/// On x86, SSSE3 and AVX2 paths process 12/24 input bytes per step and are
+/// selected at runtime from the CPU features, with a scalar path for the rest
+/// of the input and for other targets.
+////////////////////////////////////////////////////////////////////////////////
+namespace serde::base64 {
+
+/// Length of the encoding of len bytes
+constexpr size_t encoded_length(size_t len) { return (len + 2) / 3 * 4; }
+
+/// Length of the bytes encoded in src, 0 if the length of src is not a multiple of 4
+inline size_t decoded_length(const char* src, size_t len) {
+  if (len % 4)
+    return 0;
+  size_t pad = 0;
+  if (len && src[len - 1] == '=') pad++;
+  if (len > 1 && src[len - 2] == '=') pad++;
+  return len / 4 * 3 - pad;
+}
+
+enum class Impl { Scalar, SSSE3, AVX2 };
+
+namespace detail {
+
+inline constexpr char kEncode[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+struct DecodeTable {
+  int8_t val[256];
+  constexpr DecodeTable() : val() {
+    for (int i = 0; i < 256; i++) val[i] = -1;
+    for (int i = 0; i < 64; i++) val[static_cast<unsigned char>(kEncode[i])] = static_cast<int8_t>(i);
+  }
+};
+inline constexpr DecodeTable kDecode{};
+
+// encodes len bytes from src to dst, returns number of bytes consumed (a multiple of 3)
+inline size_t encode_scalar(const uint8_t* src, size_t len, char* dst) {
+  size_t i = 0;
+  for (; i + 3 <= len; i += 3, dst += 4) {
+    const uint32_t v = uint32_t(src[i]) << 16 | uint32_t(src[i + 1]) << 8 | src[i + 2];
+    dst[0] = kEncode[v >> 18];
+    dst[1] = kEncode[(v >> 12) & 0x3f];
+    dst[2] = kEncode[(v >> 6) & 0x3f];
+    dst[3] = kEncode[v & 0x3f];
+  }
+  return i;
+}
+
+// encodes the final 1 or 2 bytes with padding
+inline void encode_tail(const uint8_t* src, size_t len, char* dst) {
+  if (len == 0)
+    return;
+  const uint32_t v = uint32_t(src[0]) << 16 | (len > 1 ? uint32_t(src[1]) << 8 : 0);
+  dst[0] = kEncode[v >> 18];
+  dst[1] = kEncode[(v >> 12) & 0x3f];
+  dst[2] = len > 1 ? kEncode[(v >> 6) & 0x3f] : '=';
+  dst[3] = '=';
+}
+
+// decodes groups of 4 characters without padding from src to dst,
+// returns number of characters consumed (a multiple of 4), stops at the first invalid group
+inline size_t decode_scalar(const char* src, size_t len, uint8_t* dst) {
+  size_t i = 0;
+  for (; i + 4 <= len; i += 4, dst += 3) {
+    const int32_t a = kDecode.val[static_cast<unsigned char>(src[i])];
+    const int32_t b = kDecode.val[static_cast<unsigned char>(src[i + 1])];
+    const int32_t c = kDecode.val[static_cast<unsigned char>(src[i + 2])];
+    const int32_t d = kDecode.val[static_cast<unsigned char>(src[i + 3])];
+    if ((a | b | c | d) < 0)
+      break;
+    const uint32_t v = uint32_t(a) << 18 | uint32_t(b) << 12 | uint32_t(c) << 6 | uint32_t(d);
+    dst[0] = static_cast<uint8_t>(v >> 16);
+    dst[1] = static_cast<uint8_t>(v >> 8);
+    dst[2] = static_cast<uint8_t>(v);
+  }
+  return i;
+}
+
+#if defined(SERDE_BASE64_X86)
+
+// 12 bytes (16 loaded) -> 16 characters
+__attribute__((target("ssse3")))
+inline __m128i encode_block_ssse3(__m128i in) {
+  // split 3 bytes into 4 x 6 bits, one per output byte
+  in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+  const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+  const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+  const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+  const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+  const __m128i idx = _mm_or_si128(t1, t3);
+  // map 0..63 to the alphabet by adding a per-range offset
+  __m128i range = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+  const __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), idx);
+  range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+  const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                        '/' - 63, 'A', 0, 0);
+  return _mm_add_epi8(_mm_shuffle_epi8(offsets, range), idx);
+}
+
+__attribute__((target("ssse3")))
+inline size_t encode_ssse3(const uint8_t* src, size_t len, char* dst) {
+  size_t i = 0;
+  for (; i + 16 <= len; i += 12, dst += 16) {
+    const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), encode_block_ssse3(in));
+  }
+  return i;
+}
+
+// lanes of v within [lo, hi], characters above 0x7f compare as negative
+__attribute__((target("ssse3")))
+inline __m128i between_ssse3(__m128i v, char lo, char hi) {
+  return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1)), _mm_cmpgt_epi8(_mm_set1_epi8(hi + 1), v));
+}
+
+// 16 characters -> 12 bytes (in the low 12 bytes), valid is cleared on a non-alphabet character
+__attribute__((target("ssse3")))
+inline __m128i decode_block_ssse3(__m128i in, __m128i& valid) {
+  const __m128i upper = between_ssse3(in, 'A', 'Z');
+  const __m128i lower = between_ssse3(in, 'a', 'z');
+  const __m128i digit = between_ssse3(in, '0', '9');
+  const __m128i plus = _mm_cmpeq_epi8(in, _mm_set1_epi8('+'));
+  const __m128i slash = _mm_cmpeq_epi8(in, _mm_set1_epi8('/'));
+  valid = _mm_and_si128(valid, _mm_or_si128(_mm_or_si128(upper, lower),
+                                            _mm_or_si128(digit, _mm_or_si128(plus, slash))));
+  __m128i shift = _mm_and_si128(upper, _mm_set1_epi8(-65));
+  shift = _mm_or_si128(shift, _mm_and_si128(lower, _mm_set1_epi8(-71)));
+  shift = _mm_or_si128(shift, _mm_and_si128(digit, _mm_set1_epi8(4)));
+  shift = _mm_or_si128(shift, _mm_and_si128(plus, _mm_set1_epi8(19)));
+  shift = _mm_or_si128(shift, _mm_and_si128(slash, _mm_set1_epi8(16)));
+  const __m128i idx = _mm_add_epi8(in, shift);
+  // join 4 x 6 bits into 24 bits per 32-bit lane, then pack the 3 bytes of each lane
+  const __m128i ab_cd = _mm_maddubs_epi16(idx, _mm_set1_epi32(0x01400140));
+  const __m128i abcd = _mm_madd_epi16(ab_cd, _mm_set1_epi32(0x00011000));
+  return _mm_shuffle_epi8(abcd, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+}
+
+__attribute__((target("ssse3")))
+inline size_t decode_ssse3(const char* src, size_t len, uint8_t* dst) {
+  size_t i = 0;
+  // 16 bytes are stored for 12 decoded, keep 8 characters (6 bytes) after each step
+  for (; i + 24 <= len; i += 16, dst += 12) {
+    __m128i valid = _mm_set1_epi8(-1);
+    const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i out = decode_block_ssse3(in, valid);
+    if (_mm_movemask_epi8(valid) != 0xffff)
+      break;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), out);
+  }
+  return i;
+}
+
+// 24 bytes (12 per lane, 28 loaded) -> 32 characters
+__attribute__((target("avx2")))
+inline size_t encode_avx2(const uint8_t* src, size_t len, char* dst) {
+  size_t i = 0;
+  for (; i + 28 <= len; i += 24, dst += 32) {
+    const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 12));
+    __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+    in = _mm256_shuffle_epi8(in, _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+                                                  10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+    const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+    const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+    const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+    const __m256i idx = _mm256_or_si256(t1, t3);
+    __m256i range = _mm256_subs_epu8(idx, _mm256_set1_epi8(51));
+    const __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), idx);
+    range = _mm256_or_si256(range, _mm256_and_si256(upper, _mm256_set1_epi8(13)));
+    const __m256i offsets = _mm256_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    const __m256i out = _mm256_add_epi8(_mm256_shuffle_epi8(offsets, range), idx);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), out);
+  }
+  return i;
+}
+
+__attribute__((target("avx2")))
+inline __m256i between_avx2(__m256i v, char lo, char hi) {
+  return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(lo - 1)),
+                          _mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), v));
+}
+
+__attribute__((target("avx2")))
+inline size_t decode_avx2(const char* src, size_t len, uint8_t* dst) {
+  size_t i = 0;
+  // 32 bytes are stored for 24 decoded, keep 12 characters (9 bytes) after each step
+  for (; i + 44 <= len; i += 32, dst += 24) {
+    const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    const __m256i upper = between_avx2(in, 'A', 'Z');
+    const __m256i lower = between_avx2(in, 'a', 'z');
+    const __m256i digit = between_avx2(in, '0', '9');
+    const __m256i plus = _mm256_cmpeq_epi8(in, _mm256_set1_epi8('+'));
+    const __m256i slash = _mm256_cmpeq_epi8(in, _mm256_set1_epi8('/'));
+    const __m256i valid = _mm256_or_si256(_mm256_or_si256(upper, lower),
+                                          _mm256_or_si256(digit, _mm256_or_si256(plus, slash)));
+    if (_mm256_movemask_epi8(valid) != -1)
+      break;
+    __m256i shift = _mm256_and_si256(upper, _mm256_set1_epi8(-65));
+    shift = _mm256_or_si256(shift, _mm256_and_si256(lower, _mm256_set1_epi8(-71)));
+    shift = _mm256_or_si256(shift, _mm256_and_si256(digit, _mm256_set1_epi8(4)));
+    shift = _mm256_or_si256(shift, _mm256_and_si256(plus, _mm256_set1_epi8(19)));
+    shift = _mm256_or_si256(shift, _mm256_and_si256(slash, _mm256_set1_epi8(16)));
+    const __m256i idx = _mm256_add_epi8(in, shift);
+    const __m256i ab_cd = _mm256_maddubs_epi16(idx, _mm256_set1_epi32(0x01400140));
+    const __m256i abcd = _mm256_madd_epi16(ab_cd, _mm256_set1_epi32(0x00011000));
+    const __m256i packed = _mm256_shuffle_epi8(
+        abcd, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                               2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    // move the 12 bytes of the high lane next to the 12 bytes of the low lane
+    const __m256i out = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), out);
+  }
+  return i;
+}
+
+inline Impl detect() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return Impl::AVX2;
+  if (__builtin_cpu_supports("ssse3"))
+    return Impl::SSSE3;
+  return Impl::Scalar;
+}
+
+#else
+
+inline Impl detect() { return Impl::Scalar; }
+
+#endif // SERDE_BASE64_X86
+
+} // namespace detail
+
+/// Best implementation supported by this CPU, detected once
+inline Impl best_impl() {
+  static const Impl impl = detail::detect();
+  return impl;
+}
+
+/// Encodes len bytes of src into encoded_length(len) characters at dst (not null-terminated)
+inline void encode(const void* src, size_t len, char* dst, Impl impl = best_impl()) {
+  auto in = static_cast<const uint8_t*>(src);
+  size_t done = 0;
+#if defined(SERDE_BASE64_X86)
+  if (impl == Impl::AVX2)
+    done = detail::encode_avx2(in, len, dst);
+  if (impl == Impl::AVX2 || impl == Impl::SSSE3)
+    done += detail::encode_ssse3(in + done, len - done, dst + done / 3 * 4);
+#else
+  (void)impl;
+#endif
+  done += detail::encode_scalar(in + done, len - done, dst + done / 3 * 4);
+  detail::encode_tail(in + done, len - done, dst + done / 3 * 4);
+}
+
+/// Decodes the len characters of src into at most dst_len bytes at dst.
+/// Returns the number of bytes decoded, which is decoded_length(src, len) when dst is large enough,
+/// or -1 if src is not valid padded base64.
+inline ptrdiff_t decode(const char* src, size_t len, void* dst, size_t dst_len, Impl impl = best_impl()) {
+  if (len % 4)
+    return -1;
+  if (len == 0)
+    return 0;
+  auto out = static_cast<uint8_t*>(dst);
+  const size_t total = decoded_length(src, len);
+  // groups decoded straight into dst: all but the last, and only as many as fit
+  const size_t body = std::min(len - 4, dst_len / 3 * 4);
+  size_t done = 0;
+#if defined(SERDE_BASE64_X86)
+  if (impl == Impl::AVX2)
+    done = detail::decode_avx2(src, body, out);
+  if (impl == Impl::AVX2 || impl == Impl::SSSE3)
+    done += detail::decode_ssse3(src + done, body - done, out + done / 4 * 3);
+#else
+  (void)impl;
+#endif
+  done += detail::decode_scalar(src + done, body - done, out + done / 4 * 3);
+  if (done != body)
+    return -1;
+  // remaining groups, including the padded one, through a small buffer
+  uint8_t tail[3];
+  size_t written = done / 4 * 3;
+  for (size_t i = done; i < len; i += 4) {
+    char group[4];
+    std::memcpy(group, src + i, 4);
+    size_t n = 3;
+    if (i + 4 == len) {
+      if (group[3] == '=') { group[3] = 'A'; n--; }
+      if (group[2] == '=') {
+        if (n == 3) return -1; // "xx=y"
+        group[2] = 'A'; n--;
+      }
+    }
+    if (detail::decode_scalar(group, 4, tail) != 4)
+      return -1;
+    const size_t copy = std::min(n, dst_len - std::min(dst_len, written));
+    std::memcpy(out + written, tail, copy);
+    written += copy;
+  }
+  return static_cast<ptrdiff_t>(std::min(written, total));
+}
+
+} // namespace serde::base64
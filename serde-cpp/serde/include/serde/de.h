@@ -4,4 +4,5 @@
 #include "de/deserialize.h"
 #include "de/deserializer.h"
 #include "de/builtin.h"
+#include "de/allocator.h"
 
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <type_traits>
+#include "deserializer.h"
+
+namespace serde {
+
+namespace detail {
+
+// Uses-allocator construction of T with alloc, leading-allocator or trailing-allocator convention
+template<typename T, typename Alloc>
+inline T make_with_allocator(const Alloc& alloc) {
+  if constexpr (std::is_constructible_v<T, std::allocator_arg_t, const Alloc&>)
+    return T(std::allocator_arg, alloc);
+  else if constexpr (std::is_constructible_v<T, const Alloc&>)
+    return T(alloc);
+  else
+    return T{};
+}
+
+template<typename T>
+struct IsBasicString : std::false_type {};
+
+template<typename C, typename Traits, typename Alloc>
+struct IsBasicString<std::basic_string<C, Traits, Alloc>> : std::true_type {};
+
+} // namespace detail
+
+
+// Object of type T to deserialize into, for the std deserializers' elements and temporaries.
+// Types using a std::pmr::polymorphic_allocator get the memory resource of the deserializer
+// when it has one, by uses-allocator construction; other types are value-initialized.
+// User structs, including serde_gen ones, only get it if they are allocator-aware themselves
+// (an allocator_type and constructors taking it, passed on to their std::pmr members);
+// the std::pmr members of a plain struct use their default resource.
+template<typename T>
+inline T make_default(Deserializer& de) {
+  using PmrAlloc = std::pmr::polymorphic_allocator<std::byte>;
+  if constexpr (std::uses_allocator_v<T, PmrAlloc>) {
+    if (auto resource = de.memory_resource())
+      return detail::make_with_allocator<T>(PmrAlloc(resource));
+  }
+  return T{};
+}
+
+// Object of type T to deserialize into, going into a container with allocator alloc.
+// Allocator-aware types are built with alloc, so e.g. the keys and values of a std::pmr::map
+// come from the map's memory resource; otherwise the same as make_default(de).
+template<typename T, typename Alloc>
+inline T make_default(Deserializer& de, const Alloc& alloc) {
+  if constexpr (std::uses_allocator_v<T, Alloc>)
+    return detail::make_with_allocator<T>(alloc);
+  else
+    return make_default<T>(de);
+}
+
+// Clears an existing element of a container before it is deserialized again, so that a struct
+// element does not keep the fields its input leaves out. Strings are overwritten in full
+// and keep their storage.
+template<typename T>
+inline void reset_default(Deserializer& de, T& val) {
+  if constexpr (std::is_class_v<T> && !detail::IsBasicString<T>::value)
+    val = make_default<T>(de);
+}
+
+} // namespace serde
@@ -1,11 +1,17 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <typeinfo>
 #include "deserialize.h"
 #include "traits.h"
 
 namespace serde {
 
+/// Kind of the next value of a Deserializer, see deserialize_kind
+enum class ValueKind : uint8_t { Unknown, Null, Bool, Int, UInt, Float, Str, Bytes, Seq, Map };
+
 class Deserializer {
 public:
   template<typename T>
@@ -84,14 +90,39 @@ public:
   virtual void deserialize_struct_end() = 0;
   virtual void deserialize_struct_field_begin(const char* name) = 0;
   virtual void deserialize_struct_field_end() = 0;
+  // Whether the current struct has the field, fields it has not are left untouched.
+  // Formats that cannot tell before reading the field keep the default.
+  virtual bool deserialize_struct_field_present(const char* /*name*/) { return true; }
 
   template<typename V>
   inline void deserialize_struct_field(const char* name, V& value) {
+    if (!deserialize_struct_field_present(name))
+      return;
     deserialize_struct_field_begin(name);
     deserialize(value);
     deserialize_struct_field_end();
   }
 
+  // Shared ////////////////////////////////////////////////////////////////////
+  // Objects reached through std::shared_ptr.
+  // deserialize_shared_find returns the object of the given type that the current value
+  // refers to, if it was deserialized before, and moves past the value; otherwise nullptr
+  // and the object is deserialized, after deserialize_shared_insert made it known
+  // to later references. Formats without references keep the default.
+  virtual std::shared_ptr<void> deserialize_shared_find(const std::type_info& /*type*/) { return nullptr; }
+  virtual void deserialize_shared_insert(const std::shared_ptr<void>& /*obj*/, const std::type_info& /*type*/) {}
+
+  // Kind //////////////////////////////////////////////////////////////////////
+  // Kind of the next value (or key, between map_key_begin and map_key_end), for types
+  // such as serde::Value that take whatever the input holds. Integers only uint64_t
+  // holds are UInt. Formats that cannot tell keep the default.
+  virtual ValueKind deserialize_kind() { return ValueKind::Unknown; }
+
+  // Memory ////////////////////////////////////////////////////////////////////
+  // Memory resource of the allocator-aware objects created while deserializing
+  // that do not get one from their container (see make_default), null for the default.
+  virtual std::pmr::memory_resource* memory_resource() { return nullptr; }
+
   // Destructor
   virtual ~Deserializer() = default;
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include "../allocator.h"
 #include "../deserialize.h"
 #include "../deserializer.h"
 
@@ -11,8 +12,10 @@ struct DeserializeTN<std::array> {
   template<typename T, auto N>
   static void deserialize(Deserializer& de, std::array<T, N>& arr) {
     de.deserialize_seq_begin();
-    for (auto& e : arr)
+    for (auto& e : arr) {
+      reset_default(de, e);
       de.deserialize(e);
+    }
     de.deserialize_seq_end();
   }
 };
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <algorithm>
 #include <deque>
+#include "../allocator.h"
 #include "../deserialize.h"
 #include "../deserializer.h"
 
@@ -13,9 +15,14 @@ struct DeserializeT<std::deque> {
     size_t size = 0;
     de.deserialize_seq_size(size);
     de.deserialize_seq_begin();
+    size_t kept = std::min(deque.size(), size);
     deque.resize(size);
-    for (auto& e : deque)
+    size_t i = 0;
+    for (auto& e : deque) {
+      if (i++ < kept)
+        reset_default(de, e); // read over a previous element
       de.deserialize(e);
+    }
     de.deserialize_seq_end();
   }
 };
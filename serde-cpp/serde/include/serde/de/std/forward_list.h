@@ -1,6 +1,7 @@
 #pragma once
 
 #include <forward_list>
+#include "../allocator.h"
 #include "../deserialize.h"
 #include "../deserializer.h"
 
@@ -13,9 +14,16 @@ struct DeserializeT<std::forward_list> {
     size_t size = 0;
     de.deserialize_seq_size(size);
     de.deserialize_seq_begin();
+    size_t kept = 0;
+    for (auto it = list.begin(); it != list.end() && kept < size; ++it)
+      kept++;
     list.resize(size);
-    for (auto& e : list)
+    size_t i = 0;
+    for (auto& e : list) {
+      if (i++ < kept)
+        reset_default(de, e); // read over a previous element
       de.deserialize(e);
+    }
     de.deserialize_seq_end();
   }
 };
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <algorithm>
 #include <list>
+#include "../allocator.h"
 #include "../deserialize.h"
 #include "../deserializer.h"
 
@@ -13,9 +15,14 @@ struct DeserializeT<std::list> {
     size_t size = 0;
     de.deserialize_seq_size(size);
     de.deserialize_seq_begin();
+    size_t kept = std::min(list.size(), size);
     list.resize(size);
-    for (auto& e : list)
+    size_t i = 0;
+    for (auto& e : list) {
+      if (i++ < kept)
+        reset_default(de, e); // read over a previous element
       de.deserialize(e);
+    }
     de.deserialize_seq_end();
   }
 };
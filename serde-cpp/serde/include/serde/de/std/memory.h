@@ -1,8 +1,10 @@
 #pragma once
 
 #include <memory>
+#include <typeinfo>
 #include "../deserialize.h"
 #include "../deserializer.h"
+#include "../allocator.h"
 
 namespace serde {
 
@@ -13,7 +15,7 @@ struct DeserializeT<std::unique_ptr> {
     bool is_some = false;
     de.deserialize_is_some(is_some);
     if (is_some) {
-      if (!val) val.reset(new T());
+      val.reset(new T(make_default<T>(de))); // fresh, not merged into the previous pointee
       de.deserialize(*val);
     }
     else {
@@ -30,7 +32,12 @@ struct DeserializeT<std::shared_ptr> {
     bool is_some = false;
     de.deserialize_is_some(is_some);
     if (is_some) {
-      if (!val) val.reset(new T());
+      if (auto shared = de.deserialize_shared_find(typeid(T))) {
+        val = std::static_pointer_cast<T>(std::move(shared));
+        return;
+      }
+      val.reset(new T(make_default<T>(de))); // fresh, not merged into the previous pointee
+      de.deserialize_shared_insert(val, typeid(T));
       de.deserialize(*val);
     }
     else {
@@ -3,6 +3,7 @@
 #include <optional>
 #include "../deserialize.h"
 #include "../deserializer.h"
+#include "../allocator.h"
 
 namespace serde {
 
@@ -13,7 +14,7 @@ struct DeserializeT<std::optional> {
     bool some = false;
     de.deserialize_is_some(some);
     if (some) {
-      typename std::optional<T>::value_type inner_val;
+      auto inner_val = make_default<typename std::optional<T>::value_type>(de);
       de.deserialize(inner_val);
       val = std::move(inner_val);
     }
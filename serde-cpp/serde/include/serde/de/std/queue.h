@@ -3,6 +3,7 @@
 #include <queue>
 #include "../deserialize.h"
 #include "../deserializer.h"
+#include "../allocator.h"
 
 namespace serde {
 
@@ -15,7 +16,7 @@ struct DeserializeT<std::queue> {
     de.deserialize_seq_size(size);
     de.deserialize_seq_begin();
     for (size_t i = 0; i < size; i++) {
-      T val;
+      T val = make_default<T>(de);
       de.deserialize(val);
       queue.push(std::move(val));
     }
@@ -32,7 +33,7 @@ struct DeserializeT<std::priority_queue> {
     de.deserialize_seq_size(size);
     de.deserialize_seq_begin();
     for (size_t i = 0; i < size; i++) {
-      T val;
+      T val = make_default<T>(de);
       de.deserialize(val);
       queue.push(std::move(val));
     }
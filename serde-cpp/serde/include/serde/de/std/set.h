@@ -3,6 +3,7 @@
 #include <set>
 #include "../deserialize.h"
 #include "../deserializer.h"
+#include "../allocator.h"
 
 namespace serde {
 
@@ -15,7 +16,7 @@ struct DeserializeT<std::set> {
     de.deserialize_seq_size(size);
     de.deserialize_seq_begin();
     for (size_t i = 0; i < size; i++) {
-      Key key;
+      Key key = make_default<Key>(de, set.get_allocator());
       de.deserialize(key);
       set.emplace(std::move(key));
     }
@@ -32,7 +33,7 @@ struct DeserializeT<std::multiset> {
     de.deserialize_seq_size(size);
     de.deserialize_seq_begin();
     for (size_t i = 0; i < size; i++) {
-      Key key;
+      Key key = make_default<Key>(de, multiset.get_allocator());
       de.deserialize(key);
       multiset.emplace(std::move(key));
     }
@@ -4,6 +4,7 @@
 
 #include "../deserialize.h"
 #include "../deserializer.h"
+#include "../allocator.h"
 
 namespace serde {
 
@@ -16,7 +17,7 @@ struct DeserializeT<std::stack> {
     de.deserialize_seq_size(size);
     de.deserialize_seq_begin();
     for (size_t i = 0; i < size; i++) {
-      T val;
+      T val = make_default<T>(de);
       de.deserialize(val);
       stack.push(std::move(val));
     }
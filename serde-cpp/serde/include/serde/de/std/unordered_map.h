@@ -3,6 +3,7 @@
 #include <unordered_map>
 #include "../deserialize.h"
 #include "../deserializer.h"
+#include "../allocator.h"
 
 namespace serde {
 
@@ -15,7 +16,8 @@ struct DeserializeT<std::unordered_map> {
     de.deserialize_map_size(size);
     de.deserialize_map_begin();
     for (size_t i = 0; i < size; i++) {
-      Key key; Value value;
+      Key key = make_default<Key>(de, map.get_allocator());
+      Value value = make_default<Value>(de, map.get_allocator());
       de.deserialize_map_entry(key, value);
       map.emplace(std::move(key), std::move(value));
     }
@@ -32,7 +34,8 @@ struct DeserializeT<std::unordered_multimap> {
     de.deserialize_map_size(size);
     de.deserialize_map_begin();
     for (size_t i = 0; i < size; i++) {
-      Key key; Value value;
+      Key key = make_default<Key>(de, multimap.get_allocator());
+      Value value = make_default<Value>(de, multimap.get_allocator());
       de.deserialize_map_entry(key, value);
       multimap.emplace(std::move(key), std::move(value));
     }
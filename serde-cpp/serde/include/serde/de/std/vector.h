@@ -1,7 +1,9 @@
 #pragma once
 
+#include <algorithm>
 #include <vector>
 
+#include "../allocator.h"
 #include "../deserialize.h"
 #include "../deserializer.h"
 
@@ -14,9 +16,14 @@ struct DeserializeT<std::vector> {
     size_t size = 0;
     de.deserialize_seq_size(size);
     de.deserialize_seq_begin();
+    size_t kept = std::min(vec.size(), size);
     vec.resize(size);
-    for (auto& e : vec)
+    size_t i = 0;
+    for (auto& e : vec) {
+      if (i++ < kept)
+        reset_default(de, e); // read over a previous element
       de.deserialize(e);
+    }
     de.deserialize_seq_end();
   }
 };
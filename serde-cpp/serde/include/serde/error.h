@@ -7,6 +7,7 @@ namespace serde {
 struct Error final {
   enum class Kind {
     Invalid,
+    Syntax, // malformed input the format could not parse
   };
 
   Kind kind;
@@ -0,0 +1,442 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <vector>
+#include "ser/serializer.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SERDE_HASH_X86 1
+#include <immintrin.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+/// Content hashing
+///
+/// Hasher is a streaming 64/128-bit hash in the style of XXH3: input is
+/// consumed in 64-byte stripes by 8 lanes of 32x32->64 multiply-accumulate,
+/// scrambled every 16 stripes and folded with 128-bit multiplies at the end.
+/// On x86 an AVX2 path for runs of whole stripes is selected at runtime; it
+/// computes the same values as the scalar path, so hashes do not depend on the
+/// CPU. Hashes are stable across runs and platforms, but are not XXH3 values
+/// and not meant to resist adversarial inputs.
+///
+/// HashSerializer feeds everything serialized through it to a Hasher, giving
+/// any serde-enabled type a content hash with serde::hash / serde::hash128.
+/// Elements of unordered containers are hashed apart and summed, so equal hash
+/// sets and maps hash the same whatever their iteration order.
+////////////////////////////////////////////////////////////////////////////////
+namespace serde {
+
+struct Hash128 {
+  uint64_t low = 0;
+  uint64_t high = 0;
+
+  bool operator==(const Hash128& other) const { return low == other.low && high == other.high; }
+  bool operator!=(const Hash128& other) const { return !(*this == other); }
+};
+
+enum class HashImpl { Scalar, AVX2 };
+
+namespace detail {
+
+inline constexpr size_t kHashStripe = 64;
+inline constexpr size_t kHashStripesPerBlock = 16;
+inline constexpr uint64_t kHashPrime32 = 0x9E3779B1u;
+inline constexpr uint64_t kHashPrime64_1 = 0x9E3779B185EBCA87ull;
+inline constexpr uint64_t kHashPrime64_2 = 0xC2B2AE3D27D4EB4Full;
+
+// Words mixed into the input: per stripe [s, s+8) for stripe s of a block,
+// [16, 24) for the scramble, [8, 16) and [24, 32) for the 64 and high 128-bit folds
+struct HashSecret {
+  uint64_t word[32];
+  constexpr HashSecret() : word() {
+    uint64_t x = 0x5E7DE5EEDull; // splitmix64
+    for (auto& w : word) {
+      uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+      w = z ^ (z >> 31);
+    }
+  }
+};
+alignas(32) inline constexpr HashSecret kHashSecret{};
+
+inline uint64_t hash_read64(const uint8_t* p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  v = __builtin_bswap64(v);
+#endif
+  return v;
+}
+
+inline uint64_t hash_fold(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+  const auto product = static_cast<unsigned __int128>(a) * b;
+  return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#else
+  const uint64_t lo_lo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+  const uint64_t hi_lo = (a >> 32) * (b & 0xFFFFFFFF);
+  const uint64_t lo_hi = (a & 0xFFFFFFFF) * (b >> 32);
+  const uint64_t hi_hi = (a >> 32) * (b >> 32);
+  const uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+  const uint64_t upper = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+  const uint64_t lower = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+  return lower ^ upper;
+#endif
+}
+
+inline uint64_t hash_avalanche(uint64_t h) {
+  h ^= h >> 37;
+  h *= 0x165667919E3779F9ull;
+  h ^= h >> 32;
+  return h;
+}
+
+inline void hash_scramble(uint64_t* acc) {
+  for (size_t i = 0; i < 8; i++) {
+    uint64_t a = acc[i];
+    a ^= a >> 47;
+    a ^= kHashSecret.word[16 + i];
+    acc[i] = a * kHashPrime32;
+  }
+}
+
+// accumulates count stripes at p, stripe is the index of the first one in its block;
+// returns the index in its block of the stripe after the last one
+inline size_t hash_stripes_scalar(uint64_t* acc, const uint8_t* p, size_t count, size_t stripe) {
+  for (size_t n = 0; n < count; n++, p += kHashStripe) {
+    for (size_t i = 0; i < 8; i++) {
+      const uint64_t data = hash_read64(p + 8 * i);
+      const uint64_t key = data ^ kHashSecret.word[stripe + i];
+      acc[i ^ 1] += data;
+      acc[i] += (key & 0xFFFFFFFF) * (key >> 32);
+    }
+    if (++stripe == kHashStripesPerBlock) {
+      hash_scramble(acc);
+      stripe = 0;
+    }
+  }
+  return stripe;
+}
+
+#if defined(SERDE_HASH_X86) && !(defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+
+__attribute__((target("avx2")))
+inline __m256i hash_accumulate_avx2(__m256i acc, __m256i data, __m256i key) {
+  const __m256i mixed = _mm256_xor_si256(data, key);
+  const __m256i product = _mm256_mul_epu32(mixed, _mm256_srli_epi64(mixed, 32));
+  const __m256i swapped = _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+  return _mm256_add_epi64(_mm256_add_epi64(acc, swapped), product);
+}
+
+__attribute__((target("avx2")))
+inline __m256i hash_scramble_avx2(__m256i acc, const uint64_t* secret) {
+  const __m256i prime = _mm256_set1_epi64x(static_cast<int64_t>(kHashPrime32));
+  acc = _mm256_xor_si256(acc, _mm256_srli_epi64(acc, 47));
+  acc = _mm256_xor_si256(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(secret)));
+  // 64x32 multiply from two 32x32 products
+  const __m256i lo = _mm256_mul_epu32(acc, prime);
+  const __m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(acc, 32), prime);
+  return _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+}
+
+__attribute__((target("avx2")))
+inline size_t hash_stripes_avx2(uint64_t* acc, const uint8_t* p, size_t count, size_t stripe) {
+  __m256i acc0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc));
+  __m256i acc1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + 4));
+  for (size_t n = 0; n < count; n++, p += kHashStripe) {
+    const uint64_t* key = kHashSecret.word + stripe;
+    acc0 = hash_accumulate_avx2(acc0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)),
+                                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key)));
+    acc1 = hash_accumulate_avx2(acc1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32)),
+                                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key + 4)));
+    if (++stripe == kHashStripesPerBlock) {
+      acc0 = hash_scramble_avx2(acc0, kHashSecret.word + 16);
+      acc1 = hash_scramble_avx2(acc1, kHashSecret.word + 20);
+      stripe = 0;
+    }
+  }
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc), acc0);
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + 4), acc1);
+  return stripe;
+}
+
+inline HashImpl hash_detect() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") ? HashImpl::AVX2 : HashImpl::Scalar;
+}
+
+#else
+
+inline HashImpl hash_detect() { return HashImpl::Scalar; }
+
+#endif // SERDE_HASH_X86
+
+} // namespace detail
+
+/// Best hash implementation supported by this CPU, detected once
+inline HashImpl best_hash_impl() {
+  static const HashImpl impl = detail::hash_detect();
+  return impl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Streaming hash of a sequence of bytes, see Content hashing above
+class Hasher {
+public:
+  explicit Hasher(HashImpl impl = best_hash_impl()) : m_impl(impl) { reset(); }
+
+  void reset() {
+    static constexpr uint64_t init[8] = {
+      detail::kHashPrime32, detail::kHashPrime64_1, detail::kHashPrime64_2, 0x165667B19E3779F9ull,
+      0x85EBCA77C2B2AE63ull, 0x27D4EB2F165667C5ull, 0x61C8864E7A143579ull, 0xD6E8FEB86659FD93ull,
+    };
+    std::copy(std::begin(init), std::end(init), m_acc);
+    m_buffered = 0;
+    m_stripe = 0;
+    m_total = 0;
+  }
+
+  void update(const void* data, size_t len) {
+    if (len == 0)
+      return; // data may be null
+    auto p = static_cast<const uint8_t*>(data);
+    m_total += len;
+    if (m_buffered + len < detail::kHashStripe) {
+      std::memcpy(m_buf + m_buffered, p, len);
+      m_buffered += len;
+      return;
+    }
+    if (m_buffered) {
+      const size_t take = detail::kHashStripe - m_buffered;
+      std::memcpy(m_buf + m_buffered, p, take);
+      stripes(m_buf, 1);
+      p += take;
+      len -= take;
+      m_buffered = 0;
+    }
+    const size_t count = len / detail::kHashStripe;
+    stripes(p, count);
+    p += count * detail::kHashStripe;
+    len -= count * detail::kHashStripe;
+    std::memcpy(m_buf, p, len);
+    m_buffered = len;
+  }
+
+  /// 64-bit hash of the bytes so far, the hasher can keep being updated
+  uint64_t digest64() const {
+    uint64_t acc[8];
+    finish(acc);
+    return fold(acc, 8, m_total * detail::kHashPrime64_1);
+  }
+
+  /// 128-bit hash of the bytes so far, its low half is not digest64()
+  Hash128 digest128() const {
+    uint64_t acc[8];
+    finish(acc);
+    return {fold(acc, 0, m_total * detail::kHashPrime64_1), fold(acc, 24, ~(m_total * detail::kHashPrime64_2))};
+  }
+
+private:
+  void stripes(const uint8_t* p, size_t count) {
+    if (count == 0)
+      return;
+#if defined(SERDE_HASH_X86) && !(defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    if (m_impl == HashImpl::AVX2) {
+      m_stripe = detail::hash_stripes_avx2(m_acc, p, count, m_stripe);
+      return;
+    }
+#endif
+    m_stripe = detail::hash_stripes_scalar(m_acc, p, count, m_stripe);
+  }
+
+  // accumulators with the buffered bytes as a last zero-padded stripe
+  void finish(uint64_t* acc) const {
+    std::copy(std::begin(m_acc), std::end(m_acc), acc);
+    if (m_buffered) {
+      uint8_t last[detail::kHashStripe] = {};
+      std::memcpy(last, m_buf, m_buffered);
+      detail::hash_stripes_scalar(acc, last, 1, m_stripe);
+    }
+  }
+
+  static uint64_t fold(const uint64_t* acc, size_t secret, uint64_t seed) {
+    uint64_t h = seed;
+    for (size_t i = 0; i < 8; i += 2)
+      h += detail::hash_fold(acc[i] ^ detail::kHashSecret.word[secret + i],
+                             acc[i + 1] ^ detail::kHashSecret.word[secret + i + 1]);
+    return detail::hash_avalanche(h);
+  }
+
+  HashImpl m_impl;
+  uint64_t m_acc[8];
+  uint8_t m_buf[detail::kHashStripe];
+  size_t m_buffered;
+  size_t m_stripe;
+  uint64_t m_total;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Serializer hashing what is serialized through it instead of writing it.
+/// Each call is fed as a tag byte followed by its value, integers and floating points
+/// as little-endian bytes of their width, strings and bytes prefixed with their length.
+class HashSerializer final : public Serializer {
+public:
+  explicit HashSerializer(HashImpl impl = best_hash_impl()) : m_impl(impl), m_hasher(impl) {}
+
+  Hasher& hasher() { return m_hasher; }
+  uint64_t digest64() const { return m_hasher.digest64(); }
+  Hash128 digest128() const { return m_hasher.digest128(); }
+
+  // Scalars ///////////////////////////////////////////////////////////////////
+  void serialize_bool(bool v) override { scalar(Tag::Bool, static_cast<uint8_t>(v)); }
+  void serialize_i8(int8_t v) override { scalar(Tag::I8, static_cast<uint8_t>(v)); }
+  void serialize_u8(uint8_t v) override { scalar(Tag::U8, v); }
+  void serialize_i16(int16_t v) override { scalar(Tag::I16, static_cast<uint16_t>(v)); }
+  void serialize_u16(uint16_t v) override { scalar(Tag::U16, v); }
+  void serialize_i32(int32_t v) override { scalar(Tag::I32, static_cast<uint32_t>(v)); }
+  void serialize_u32(uint32_t v) override { scalar(Tag::U32, v); }
+  void serialize_i64(int64_t v) override { scalar(Tag::I64, static_cast<uint64_t>(v)); }
+  void serialize_u64(uint64_t v) override { scalar(Tag::U64, v); }
+  void serialize_float(float v) override { uint32_t u; std::memcpy(&u, &v, sizeof(u)); scalar(Tag::Float, u); }
+  void serialize_double(double v) override { uint64_t u; std::memcpy(&u, &v, sizeof(u)); scalar(Tag::Double, u); }
+  void serialize_char(char v) override { scalar(Tag::Char, static_cast<uint8_t>(v)); }
+  void serialize_uchar(unsigned char v) override { scalar(Tag::UChar, v); }
+  void serialize_cstr(const char* v) override { blob(Tag::Str, v, std::strlen(v)); value_end(); }
+  void serialize_bytes(const void* v, size_t len) override { blob(Tag::Bytes, v, len); value_end(); }
+
+  // Optional //////////////////////////////////////////////////////////////////
+  void serialize_none() override { tag(Tag::None); value_end(); }
+  void serialize_some() override { tag(Tag::Some); }
+
+  // Sequence //////////////////////////////////////////////////////////////////
+  void serialize_seq_begin() override { begin(Tag::SeqBegin); }
+  void serialize_seq_end() override { end(Tag::SeqEnd); }
+
+  // Map ///////////////////////////////////////////////////////////////////////
+  void serialize_map_begin() override { begin(Tag::MapBegin); }
+  void serialize_map_end() override { end(Tag::MapEnd); }
+  void serialize_map_key_begin() override { tag(Tag::Key); }
+  void serialize_map_key_end() override {}
+  void serialize_map_value_begin() override { tag(Tag::Value); }
+  void serialize_map_value_end() override {
+    if (!m_unordered.empty() && m_unordered.back().map && m_unordered.back().depth == m_depth)
+      element_end(m_unordered.back());
+  }
+  void serialize_unordered() override {
+    m_unordered.push_back({m_depth, m_map_begun, Hasher(m_impl)});
+  }
+
+  // Struct ////////////////////////////////////////////////////////////////////
+  void serialize_struct_begin() override { begin(Tag::StructBegin); }
+  void serialize_struct_end() override { end(Tag::StructEnd); }
+  void serialize_struct_field_begin(const char* name) override { blob(Tag::Field, name, std::strlen(name)); }
+  void serialize_struct_field_end() override {}
+
+private:
+  // new tags go last, the values of the others are part of the hashes
+  enum class Tag : uint8_t {
+    Bool = 1, I8, U8, I16, U16, I32, U32, I64, U64, Float, Double, Char, UChar, Str, Bytes,
+    None, SeqBegin, SeqEnd, MapBegin, MapEnd, Key, Value, StructBegin, StructEnd, Field,
+    Some, Unordered,
+  };
+
+  // Unordered container being hashed: each element (or entry) into element, then summed
+  struct Unordered {
+    size_t depth; // m_depth inside the container
+    bool map;
+    Hasher element;
+    uint64_t count = 0;
+    Hash128 sum;
+  };
+
+  // Hasher of the innermost unordered element being hashed, or the whole value's
+  Hasher& out() { return m_unordered.empty() ? m_hasher : m_unordered.back().element; }
+
+  void tag(Tag t) {
+    const auto byte = static_cast<uint8_t>(t);
+    out().update(&byte, 1);
+  }
+
+  template<typename U>
+  void write(Tag t, U v) {
+    uint8_t buf[1 + sizeof(U)];
+    buf[0] = static_cast<uint8_t>(t);
+    for (size_t i = 0; i < sizeof(U); i++)
+      buf[1 + i] = static_cast<uint8_t>(static_cast<uint64_t>(v) >> (8 * i));
+    out().update(buf, sizeof(buf));
+  }
+
+  template<typename U>
+  void scalar(Tag t, U v) {
+    write(t, v);
+    value_end();
+  }
+
+  void blob(Tag t, const void* data, size_t len) {
+    write(t, static_cast<uint64_t>(len));
+    out().update(data, len);
+  }
+
+  void begin(Tag t) {
+    tag(t);
+    m_depth++;
+    m_map_begun = t == Tag::MapBegin;
+  }
+
+  void end(Tag t) {
+    if (!m_unordered.empty() && m_unordered.back().depth == m_depth) {
+      const Unordered set = std::move(m_unordered.back());
+      m_unordered.pop_back();
+      write(Tag::Unordered, set.count);
+      write(Tag::Unordered, set.sum.low);
+      write(Tag::Unordered, set.sum.high);
+    }
+    tag(t);
+    m_depth--;
+    value_end();
+  }
+
+  // A whole value was hashed, the end of an element of an unordered sequence it is directly in
+  void value_end() {
+    if (!m_unordered.empty() && !m_unordered.back().map && m_unordered.back().depth == m_depth)
+      element_end(m_unordered.back());
+  }
+
+  void element_end(Unordered& set) {
+    const auto digest = set.element.digest128();
+    set.sum.low += digest.low;
+    set.sum.high += digest.high;
+    set.count++;
+    set.element.reset();
+  }
+
+  HashImpl m_impl;
+  Hasher m_hasher;
+  size_t m_depth = 0; // open sequences, maps and structs
+  bool m_map_begun = false; // last container begun is a map
+  std::vector<Unordered> m_unordered;
+};
+
+/// 64-bit content hash of obj, stable across runs and platforms
+template<typename T>
+uint64_t hash(const T& obj) {
+  HashSerializer ser;
+  ser.serialize(obj);
+  return ser.digest64();
+}
+
+/// 128-bit content hash of obj, stable across runs and platforms
+template<typename T>
+Hash128 hash128(const T& obj) {
+  HashSerializer ser;
+  ser.serialize(obj);
+  return ser.digest128();
+}
+
+} // namespace serde
@@ -0,0 +1,322 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+#include "ser/serializer.h"
+#include "de/deserializer.h"
+
+namespace serde {
+
+////////////////////////////////////////////////////////////////////////////////
+/// Profiling
+///
+/// ProfilingSerializer and ProfilingDeserializer wrap another implementation,
+/// forward every call to it and record into a Profile the calls, bytes and
+/// time spent per method and per struct field name. Bytes are the in-memory
+/// size of the scalars, strings and blobs passed through, a measure of the
+/// payload independent of the format. Field entries are inclusive: they hold
+/// everything serialized under the field, nested fields included.
+///
+/// A Profile is not synchronized, use one per thread and merge() them.
+/// Profile::sample() picks the messages to profile, e.g. 1 in 100:
+///
+///   if (profile.sample(100)) {
+///     serde::ProfilingSerializer prof(ser, profile);
+///     prof.serialize(msg);
+///   } else {
+///     ser.serialize(msg);
+///   }
+///   ...
+///   profile.report(std::cerr);
+class Profile {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  /// Cost recorded for a method or a field
+  struct Entry {
+    uint64_t calls = 0;
+    uint64_t bytes = 0;
+    Clock::duration time{};
+
+    Entry& operator+=(const Entry& other) {
+      calls += other.calls;
+      bytes += other.bytes;
+      time += other.time;
+      return *this;
+    }
+  };
+
+  /// Entries per method name, e.g. "serialize_i32"
+  const std::map<std::string, Entry, std::less<>>& methods() const { return m_methods; }
+  /// Entries per struct field name
+  const std::map<std::string, Entry, std::less<>>& fields() const { return m_fields; }
+
+  void record_method(std::string_view method, uint64_t bytes, Clock::duration time) {
+    add(m_methods, method, {1, bytes, time});
+  }
+  void record_field(std::string_view name, uint64_t bytes, Clock::duration time) {
+    add(m_fields, name, {1, bytes, time});
+  }
+
+  /// Adds the entries of another profile, e.g. from another thread
+  void merge(const Profile& other) {
+    for (auto& [name, entry] : other.m_methods) add(m_methods, name, entry);
+    for (auto& [name, entry] : other.m_fields) add(m_fields, name, entry);
+  }
+
+  void clear() {
+    m_methods.clear();
+    m_fields.clear();
+  }
+
+  /// True once every one_in calls, counted across threads
+  bool sample(uint32_t one_in) {
+    return one_in <= 1 || m_samples.fetch_add(1, std::memory_order_relaxed) % one_in == 0;
+  }
+
+  /// Writes the methods and fields, most time consuming first
+  void report(std::ostream& os) const {
+    report(os, "method", m_methods);
+    report(os, "field", m_fields);
+  }
+
+private:
+  using Entries = std::map<std::string, Entry, std::less<>>;
+
+  static void add(Entries& entries, std::string_view name, const Entry& entry) {
+    auto it = entries.find(name);
+    if (it == entries.end())
+      it = entries.emplace(std::string(name), Entry{}).first;
+    it->second += entry;
+  }
+
+  static void report(std::ostream& os, const char* title, const Entries& entries) {
+    std::vector<std::pair<const std::string*, const Entry*>> sorted;
+    sorted.reserve(entries.size());
+    for (auto& [name, entry] : entries) sorted.emplace_back(&name, &entry);
+    std::sort(sorted.begin(), sorted.end(),
+              [](auto& a, auto& b) { return a.second->time > b.second->time; });
+    os << title << "\tcalls\tbytes\ttime_ns\n";
+    for (auto& [name, entry] : sorted) {
+      const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(entry->time).count();
+      os << *name << '\t' << entry->calls << '\t' << entry->bytes << '\t' << ns << '\n';
+    }
+  }
+
+  Entries m_methods;
+  Entries m_fields;
+  std::atomic<uint32_t> m_samples{0};
+};
+
+namespace detail {
+
+/// Open struct fields of a profiling (de)serializer, recorded when they end
+class ProfileFields {
+public:
+  void begin(const char* name, uint64_t bytes) {
+    m_open.push_back({name, bytes, Profile::Clock::now()});
+  }
+  void end(Profile& profile, uint64_t bytes) {
+    if (m_open.empty())
+      return;
+    auto& field = m_open.back();
+    profile.record_field(field.name, bytes - field.bytes, Profile::Clock::now() - field.start);
+    m_open.pop_back();
+  }
+
+private:
+  struct Open {
+    const char* name;
+    uint64_t bytes;
+    Profile::Clock::time_point start;
+  };
+  std::vector<Open> m_open;
+};
+
+} // namespace detail
+
+////////////////////////////////////////////////////////////////////////////////
+/// Serializer forwarding to another one while recording into a Profile
+class ProfilingSerializer : public Serializer {
+public:
+  ProfilingSerializer(Serializer& inner, Profile& profile) : m_inner(inner), m_profile(profile) {}
+
+  // Scalars ///////////////////////////////////////////////////////////////////
+  void serialize_bool(bool v) override { call("serialize_bool", sizeof(v), &Serializer::serialize_bool, v); }
+  void serialize_i8(int8_t v) override { call("serialize_i8", sizeof(v), &Serializer::serialize_i8, v); }
+  void serialize_u8(uint8_t v) override { call("serialize_u8", sizeof(v), &Serializer::serialize_u8, v); }
+  void serialize_i16(int16_t v) override { call("serialize_i16", sizeof(v), &Serializer::serialize_i16, v); }
+  void serialize_u16(uint16_t v) override { call("serialize_u16", sizeof(v), &Serializer::serialize_u16, v); }
+  void serialize_i32(int32_t v) override { call("serialize_i32", sizeof(v), &Serializer::serialize_i32, v); }
+  void serialize_u32(uint32_t v) override { call("serialize_u32", sizeof(v), &Serializer::serialize_u32, v); }
+  void serialize_i64(int64_t v) override { call("serialize_i64", sizeof(v), &Serializer::serialize_i64, v); }
+  void serialize_u64(uint64_t v) override { call("serialize_u64", sizeof(v), &Serializer::serialize_u64, v); }
+  void serialize_float(float v) override { call("serialize_float", sizeof(v), &Serializer::serialize_float, v); }
+  void serialize_double(double v) override { call("serialize_double", sizeof(v), &Serializer::serialize_double, v); }
+  void serialize_char(char v) override { call("serialize_char", sizeof(v), &Serializer::serialize_char, v); }
+  void serialize_uchar(unsigned char v) override { call("serialize_uchar", sizeof(v), &Serializer::serialize_uchar, v); }
+  void serialize_cstr(const char* v) override { call("serialize_cstr", std::strlen(v), &Serializer::serialize_cstr, v); }
+  void serialize_bytes(const void* v, size_t len) override { call("serialize_bytes", len, &Serializer::serialize_bytes, v, len); }
+
+  // Optional //////////////////////////////////////////////////////////////////
+  void serialize_none() override { call("serialize_none", 0, &Serializer::serialize_none); }
+  void serialize_some() override { call("serialize_some", 0, &Serializer::serialize_some); }
+
+  // Sequence //////////////////////////////////////////////////////////////////
+  void serialize_seq_begin() override { call("serialize_seq_begin", 0, &Serializer::serialize_seq_begin); }
+  void serialize_seq_end() override { call("serialize_seq_end", 0, &Serializer::serialize_seq_end); }
+
+  // Map ///////////////////////////////////////////////////////////////////////
+  void serialize_map_begin() override { call("serialize_map_begin", 0, &Serializer::serialize_map_begin); }
+  void serialize_map_end() override { call("serialize_map_end", 0, &Serializer::serialize_map_end); }
+  void serialize_map_key_begin() override { call("serialize_map_key_begin", 0, &Serializer::serialize_map_key_begin); }
+  void serialize_map_key_end() override { call("serialize_map_key_end", 0, &Serializer::serialize_map_key_end); }
+  void serialize_map_value_begin() override { call("serialize_map_value_begin", 0, &Serializer::serialize_map_value_begin); }
+  void serialize_map_value_end() override { call("serialize_map_value_end", 0, &Serializer::serialize_map_value_end); }
+  void serialize_unordered() override { call("serialize_unordered", 0, &Serializer::serialize_unordered); }
+
+  // Struct ////////////////////////////////////////////////////////////////////
+  void serialize_struct_begin() override { call("serialize_struct_begin", 0, &Serializer::serialize_struct_begin); }
+  void serialize_struct_end() override { call("serialize_struct_end", 0, &Serializer::serialize_struct_end); }
+  void serialize_struct_field_begin(const char* name) override {
+    m_fields.begin(name, m_bytes);
+    call("serialize_struct_field_begin", 0, &Serializer::serialize_struct_field_begin, name);
+  }
+  void serialize_struct_field_end() override {
+    call("serialize_struct_field_end", 0, &Serializer::serialize_struct_field_end);
+    m_fields.end(m_profile, m_bytes);
+  }
+
+  // Shared ////////////////////////////////////////////////////////////////////
+  bool serialize_shared_begin(const void* ptr, const std::type_info& type) override {
+    return call("serialize_shared_begin", 0, &Serializer::serialize_shared_begin, ptr, type);
+  }
+  void serialize_shared_end() override { call("serialize_shared_end", 0, &Serializer::serialize_shared_end); }
+
+private:
+  template<typename R, typename... Params, typename... Args>
+  R call(std::string_view name, uint64_t bytes, R (Serializer::*method)(Params...), Args&&... args) {
+    const auto start = Profile::Clock::now();
+    struct Record {
+      ProfilingSerializer& self;
+      std::string_view name;
+      uint64_t bytes;
+      Profile::Clock::time_point start;
+      ~Record() { self.m_profile.record_method(name, bytes, Profile::Clock::now() - start); }
+    } record{*this, name, bytes, start};
+    m_bytes += bytes;
+    return (m_inner.*method)(std::forward<Args>(args)...);
+  }
+
+  Serializer& m_inner;
+  Profile& m_profile;
+  uint64_t m_bytes = 0;
+  detail::ProfileFields m_fields;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Deserializer forwarding to another one while recording into a Profile
+class ProfilingDeserializer : public Deserializer {
+public:
+  ProfilingDeserializer(Deserializer& inner, Profile& profile) : m_inner(inner), m_profile(profile) {}
+
+  // Scalars ///////////////////////////////////////////////////////////////////
+  void deserialize_bool(bool& v) override { call("deserialize_bool", sizeof(v), &Deserializer::deserialize_bool, v); }
+  void deserialize_i8(int8_t& v) override { call("deserialize_i8", sizeof(v), &Deserializer::deserialize_i8, v); }
+  void deserialize_u8(uint8_t& v) override { call("deserialize_u8", sizeof(v), &Deserializer::deserialize_u8, v); }
+  void deserialize_i16(int16_t& v) override { call("deserialize_i16", sizeof(v), &Deserializer::deserialize_i16, v); }
+  void deserialize_u16(uint16_t& v) override { call("deserialize_u16", sizeof(v), &Deserializer::deserialize_u16, v); }
+  void deserialize_i32(int32_t& v) override { call("deserialize_i32", sizeof(v), &Deserializer::deserialize_i32, v); }
+  void deserialize_u32(uint32_t& v) override { call("deserialize_u32", sizeof(v), &Deserializer::deserialize_u32, v); }
+  void deserialize_i64(int64_t& v) override { call("deserialize_i64", sizeof(v), &Deserializer::deserialize_i64, v); }
+  void deserialize_u64(uint64_t& v) override { call("deserialize_u64", sizeof(v), &Deserializer::deserialize_u64, v); }
+  void deserialize_float(float& v) override { call("deserialize_float", sizeof(v), &Deserializer::deserialize_float, v); }
+  void deserialize_double(double& v) override { call("deserialize_double", sizeof(v), &Deserializer::deserialize_double, v); }
+  void deserialize_char(char& v) override { call("deserialize_char", sizeof(v), &Deserializer::deserialize_char, v); }
+  void deserialize_uchar(unsigned char& v) override { call("deserialize_uchar", sizeof(v), &Deserializer::deserialize_uchar, v); }
+  void deserialize_cstr(char* v, size_t len) override { call("deserialize_cstr", len, &Deserializer::deserialize_cstr, v, len); }
+  void deserialize_bytes(void* v, size_t len) override { call("deserialize_bytes", len, &Deserializer::deserialize_bytes, v, len); }
+  void deserialize_length(size_t& len) override { call("deserialize_length", 0, &Deserializer::deserialize_length, len); }
+
+  // Optional //////////////////////////////////////////////////////////////////
+  void deserialize_is_some(bool& v) override { call("deserialize_is_some", 0, &Deserializer::deserialize_is_some, v); }
+  void deserialize_none() override { call("deserialize_none", 0, &Deserializer::deserialize_none); }
+
+  // Sequence //////////////////////////////////////////////////////////////////
+  void deserialize_seq_begin() override { call("deserialize_seq_begin", 0, &Deserializer::deserialize_seq_begin); }
+  void deserialize_seq_size(size_t& v) override { call("deserialize_seq_size", 0, &Deserializer::deserialize_seq_size, v); }
+  void deserialize_seq_end() override { call("deserialize_seq_end", 0, &Deserializer::deserialize_seq_end); }
+
+  // Map ///////////////////////////////////////////////////////////////////////
+  void deserialize_map_begin() override { call("deserialize_map_begin", 0, &Deserializer::deserialize_map_begin); }
+  void deserialize_map_size(size_t& v) override { call("deserialize_map_size", 0, &Deserializer::deserialize_map_size, v); }
+  void deserialize_map_end() override { call("deserialize_map_end", 0, &Deserializer::deserialize_map_end); }
+  void deserialize_map_key_begin() override { call("deserialize_map_key_begin", 0, &Deserializer::deserialize_map_key_begin); }
+  void deserialize_map_key_end() override { call("deserialize_map_key_end", 0, &Deserializer::deserialize_map_key_end); }
+  void deserialize_map_key_find(const char* key) override { call("deserialize_map_key_find", 0, &Deserializer::deserialize_map_key_find, key); }
+  void deserialize_map_value_begin() override { call("deserialize_map_value_begin", 0, &Deserializer::deserialize_map_value_begin); }
+  void deserialize_map_value_end() override { call("deserialize_map_value_end", 0, &Deserializer::deserialize_map_value_end); }
+
+  // Struct ////////////////////////////////////////////////////////////////////
+  void deserialize_struct_begin() override { call("deserialize_struct_begin", 0, &Deserializer::deserialize_struct_begin); }
+  void deserialize_struct_end() override { call("deserialize_struct_end", 0, &Deserializer::deserialize_struct_end); }
+  void deserialize_struct_field_begin(const char* name) override {
+    m_fields.begin(name, m_bytes);
+    call("deserialize_struct_field_begin", 0, &Deserializer::deserialize_struct_field_begin, name);
+  }
+  void deserialize_struct_field_end() override {
+    call("deserialize_struct_field_end", 0, &Deserializer::deserialize_struct_field_end);
+    m_fields.end(m_profile, m_bytes);
+  }
+  bool deserialize_struct_field_present(const char* name) override {
+    return call("deserialize_struct_field_present", 0, &Deserializer::deserialize_struct_field_present, name);
+  }
+
+  // Shared ////////////////////////////////////////////////////////////////////
+  std::shared_ptr<void> deserialize_shared_find(const std::type_info& type) override {
+    return call("deserialize_shared_find", 0, &Deserializer::deserialize_shared_find, type);
+  }
+  void deserialize_shared_insert(const std::shared_ptr<void>& obj, const std::type_info& type) override {
+    call("deserialize_shared_insert", 0, &Deserializer::deserialize_shared_insert, obj, type);
+  }
+
+  // Kind //////////////////////////////////////////////////////////////////////
+  ValueKind deserialize_kind() override { return call("deserialize_kind", 0, &Deserializer::deserialize_kind); }
+
+  // Memory ////////////////////////////////////////////////////////////////////
+  std::pmr::memory_resource* memory_resource() override { return m_inner.memory_resource(); }
+
+private:
+  template<typename R, typename... Params, typename... Args>
+  R call(std::string_view name, uint64_t bytes, R (Deserializer::*method)(Params...), Args&&... args) {
+    const auto start = Profile::Clock::now();
+    struct Record {
+      ProfilingDeserializer& self;
+      std::string_view name;
+      uint64_t bytes;
+      Profile::Clock::time_point start;
+      ~Record() { self.m_profile.record_method(name, bytes, Profile::Clock::now() - start); }
+    } record{*this, name, bytes, start};
+    m_bytes += bytes;
+    return (m_inner.*method)(std::forward<Args>(args)...);
+  }
+
+  Deserializer& m_inner;
+  Profile& m_profile;
+  uint64_t m_bytes = 0;
+  detail::ProfileFields m_fields;
+};
+
+} // namespace serde
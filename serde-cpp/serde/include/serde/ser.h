@@ -4,4 +4,5 @@
 #include "ser/serialize.h"
 #include "ser/serializer.h"
 #include "ser/builtin.h"
+#include "ser/static.h"
 
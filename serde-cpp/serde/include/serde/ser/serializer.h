@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <typeinfo>
 #include "serialize.h"
 #include "traits.h"
 
@@ -51,6 +52,8 @@ public:
 
   // Optional //////////////////////////////////////////////////////////////////
   virtual void serialize_none() = 0;
+  /// Called before the value of a present optional or pointer, for formats that tag presence
+  virtual void serialize_some() {}
 
   // Sequence //////////////////////////////////////////////////////////////////
   virtual void serialize_seq_begin() = 0;
@@ -63,6 +66,9 @@ public:
   virtual void serialize_map_key_end() = 0;
   virtual void serialize_map_value_begin() = 0;
   virtual void serialize_map_value_end() = 0;
+  /// Called after serialize_seq_begin or serialize_map_begin of a container whose order
+  /// is not part of its value (hash sets and maps), for formats that compare contents
+  virtual void serialize_unordered() {}
 
   template<typename K>
   inline void serialize_map_key(const K& key) {
@@ -97,6 +103,15 @@ public:
     serialize_struct_field_end();
   }
 
+  // Shared ////////////////////////////////////////////////////////////////////
+  // Objects reached through std::shared_ptr, identified by address and type.
+  // serialize_shared_begin returns true when the object was serialized before and a
+  // reference to it was written instead, so it must not be serialized again; otherwise
+  // the object is serialized and followed by serialize_shared_end.
+  // Formats without references keep the default, serializing every occurrence.
+  virtual bool serialize_shared_begin(const void* /*ptr*/, const std::type_info& /*type*/) { return false; }
+  virtual void serialize_shared_end() {}
+
   // Flat //////////////////////////////////////////////////////////////////////
   // template<typename T> void serialize_flat(const T& v);
   // virtual void serialize_flat_begin() = 0;
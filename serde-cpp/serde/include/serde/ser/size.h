@@ -0,0 +1,310 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "serialize.h"
+#include "serializer.h"
+#include "traits.h"
+
+namespace serde {
+
+////////////////////////////////////////////////////////////////////////////////
+/// Size models
+///
+/// A size model tells how many bytes an encoding spends on each Serializer call,
+/// so the encoded size of a value can be computed before (or instead of) encoding it.
+/// Models provide the following static functions:
+///   scalar(v)        bytes of a bool, char, integer or floating point value
+///   string(len)      bytes of a string of len characters (serialize_cstr)
+///   bytes(len)       bytes of a binary blob of len bytes (serialize_bytes)
+///   none()           bytes of an empty optional or null pointer (serialize_none)
+///   some()           bytes of the presence tag of a present optional or pointer (serialize_some)
+///   seq(count)       overhead of a sequence of count elements
+///   element()        overhead of each sequence element
+///   map(count)       overhead of a map of count entries
+///   entry()          overhead of each map entry
+///   structure()      overhead of a struct
+///   field(name)      overhead of each struct field
+/// and `fixed_width`, true if scalar(v) does not depend on the value.
+namespace size {
+
+/// Fixed-width binary encoding: scalars take their own width, strings, bytes, sequences and
+/// maps are prefixed with a 64-bit length, optionals a 1-byte presence tag and struct fields are positional.
+struct Fixed {
+  static constexpr bool fixed_width = true;
+  template<typename T>
+  static constexpr size_t scalar(T) { return sizeof(T); }
+  static constexpr size_t string(size_t len) { return sizeof(uint64_t) + len; }
+  static constexpr size_t bytes(size_t len) { return sizeof(uint64_t) + len; }
+  static constexpr size_t none() { return 1; }
+  static constexpr size_t some() { return 1; }
+  static constexpr size_t seq(size_t) { return sizeof(uint64_t); }
+  static constexpr size_t element() { return 0; }
+  static constexpr size_t map(size_t) { return sizeof(uint64_t); }
+  static constexpr size_t entry() { return 0; }
+  static constexpr size_t structure() { return 0; }
+  static constexpr size_t field(const char*) { return 0; }
+};
+
+/// Variable-width binary encoding: integers and lengths are LEB128 varints (signed integers
+/// zigzag encoded), floating points keep their width, otherwise same as Fixed.
+struct Varint {
+  static constexpr bool fixed_width = false;
+
+  static constexpr size_t varint(uint64_t v) {
+    size_t len = 1;
+    while (v >= 0x80) { v >>= 7; len++; }
+    return len;
+  }
+
+  template<typename T>
+  static constexpr size_t scalar(T v) {
+    if constexpr (std::is_floating_point_v<T> || sizeof(T) == 1) return sizeof(T);
+    else if constexpr (std::is_signed_v<T>) {
+      auto u = static_cast<uint64_t>(static_cast<int64_t>(v));
+      return varint((u << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(v) >> 63));
+    }
+    else return varint(static_cast<uint64_t>(v));
+  }
+  static constexpr size_t string(size_t len) { return varint(len) + len; }
+  static constexpr size_t bytes(size_t len) { return varint(len) + len; }
+  static constexpr size_t none() { return 1; }
+  static constexpr size_t some() { return 1; }
+  static constexpr size_t seq(size_t count) { return varint(count); }
+  static constexpr size_t element() { return 0; }
+  static constexpr size_t map(size_t count) { return varint(count); }
+  static constexpr size_t entry() { return 0; }
+  static constexpr size_t structure() { return 0; }
+  static constexpr size_t field(const char*) { return 0; }
+};
+
+} // namespace size
+
+
+namespace traits {
+
+template<typename T, typename = void>
+struct IsOptionalLike : public std::false_type {};
+
+template<typename T>
+struct IsOptionalLike<T, std::void_t<decltype(std::declval<const T&>().has_value()),
+                                     decltype(*std::declval<const T&>())>>
+: public std::true_type {};
+
+template<typename T, typename = void>
+struct IsPointerLike : public std::false_type {};
+
+template<typename T>
+struct IsPointerLike<T, std::void_t<typename T::element_type, decltype(std::declval<const T&>().get()),
+                                    decltype(*std::declval<const T&>())>>
+: public std::true_type {};
+
+template<typename T, typename = void>
+struct IsMapLike : public std::false_type {};
+
+template<typename T>
+struct IsMapLike<T, std::void_t<typename T::key_type, typename T::mapped_type,
+                                decltype(std::begin(std::declval<const T&>()))>>
+: public std::true_type {};
+
+template<typename T, typename = void>
+struct IsSeqLike : public std::false_type {};
+
+template<typename T>
+struct IsSeqLike<T, std::void_t<typename T::value_type, decltype(std::begin(std::declval<const T&>())),
+                                decltype(std::end(std::declval<const T&>()))>>
+: public std::true_type {};
+
+template<typename T>
+struct IsStringLike : public std::false_type {};
+
+template<typename Traits, typename Alloc>
+struct IsStringLike<std::basic_string<char, Traits, Alloc>> : public std::true_type {};
+
+template<typename Traits>
+struct IsStringLike<std::basic_string_view<char, Traits>> : public std::true_type {};
+
+template<typename T>
+struct IsPair : public std::false_type {};
+
+template<typename T1, typename T2>
+struct IsPair<std::pair<T1, T2>> : public std::true_type {};
+
+template<typename T>
+struct IsTuple : public std::false_type {};
+
+template<typename... Ts>
+struct IsTuple<std::tuple<Ts...>> : public std::true_type {};
+
+template<typename T>
+struct IsVariant : public std::false_type {};
+
+template<typename... Ts>
+struct IsVariant<std::variant<Ts...>> : public std::true_type {};
+
+template<typename T>
+inline constexpr bool AlwaysFalse = false;
+
+} // namespace traits
+
+
+// Encoded size of val in the encoding described by Model, following the same Serializer calls
+// as the builtin serialization of std types and the Serialize<T> generated by serde_gen.
+// Only lengths of strings and containers are walked when the Model is fixed-width.
+template<typename Model, typename T>
+inline size_t serialized_size(const T& val) {
+  if constexpr (traits::HasSizedSerialize<T, Model>::value) {
+    return Serialize<T>::template serialized_size<Model>(val);
+  }
+  else if constexpr (std::is_arithmetic_v<T>) {
+    return Model::scalar(val);
+  }
+  else if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, char*>) {
+    return Model::string(std::strlen(val));
+  }
+  else if constexpr (std::is_array_v<T> && std::is_same_v<std::remove_extent_t<T>, char>) {
+    return Model::string(std::strlen(val));
+  }
+  else if constexpr (traits::IsStringLike<T>::value) {
+    return Model::string(val.size());
+  }
+  else if constexpr (traits::IsPointerLike<T>::value || traits::IsOptionalLike<T>::value) {
+    return val ? Model::some() + serialized_size<Model>(*val) : Model::none();
+  }
+  else if constexpr (traits::IsPair<T>::value) {
+    return Model::structure()
+        + Model::field("first") + serialized_size<Model>(val.first)
+        + Model::field("second") + serialized_size<Model>(val.second);
+  }
+  else if constexpr (traits::IsTuple<T>::value) {
+    return Model::seq(std::tuple_size_v<T>) + std::apply([](const auto&... args) {
+      return (size_t{0} + ... + (Model::element() + serialized_size<Model>(args)));
+    }, val);
+  }
+  else if constexpr (traits::IsVariant<T>::value) {
+    return Model::map(1) + Model::entry() + Model::scalar(val.index())
+        + std::visit([](const auto& v) { return serialized_size<Model>(v); }, val);
+  }
+  else if constexpr (traits::IsMapLike<T>::value) {
+    size_t size = 0, count = 0;
+    for (const auto& [key, value] : val) {
+      size += Model::entry() + serialized_size<Model>(key) + serialized_size<Model>(value);
+      count++;
+    }
+    return Model::map(count) + size;
+  }
+  else if constexpr (traits::IsSeqLike<T>::value) {
+    using E = typename T::value_type;
+    const auto count = static_cast<size_t>(std::distance(std::begin(val), std::end(val)));
+    if constexpr (Model::fixed_width && std::is_arithmetic_v<E>) {
+      return Model::seq(count) + count * (Model::element() + Model::scalar(E{}));
+    }
+    else {
+      size_t size = Model::seq(count);
+      for (const auto& e : val)
+        size += Model::element() + serialized_size<Model>(e);
+      return size;
+    }
+  }
+  else {
+    static_assert(traits::AlwaysFalse<T>, "no serialized_size for T, generate it with serde_gen --serialized_size");
+    return 0;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Size-only serializer
+///
+/// Computes the encoded size of whatever is serialized through it in the encoding
+/// described by Model, without writing anything. Same result as serialized_size<Model>,
+/// for any type with a serde::serialize, at the cost of the virtual calls:
+///
+///   serde::SizeSerializer<serde::size::Varint> ser;
+///   ser.serialize(msg);
+///   if (ser.size() > quota) ...
+template<typename Model>
+class SizeSerializer final : public Serializer {
+public:
+  /// Bytes of everything serialized so far
+  size_t size() const { return m_size; }
+
+  void reset() {
+    m_size = 0;
+    m_frames.clear();
+  }
+
+  // Scalars ///////////////////////////////////////////////////////////////////
+  void serialize_bool(bool v) override { scalar(v); }
+  void serialize_i8(int8_t v) override { scalar(v); }
+  void serialize_u8(uint8_t v) override { scalar(v); }
+  void serialize_i16(int16_t v) override { scalar(v); }
+  void serialize_u16(uint16_t v) override { scalar(v); }
+  void serialize_i32(int32_t v) override { scalar(v); }
+  void serialize_u32(uint32_t v) override { scalar(v); }
+  void serialize_i64(int64_t v) override { scalar(v); }
+  void serialize_u64(uint64_t v) override { scalar(v); }
+  void serialize_float(float v) override { scalar(v); }
+  void serialize_double(double v) override { scalar(v); }
+  void serialize_char(char v) override { scalar(v); }
+  void serialize_uchar(unsigned char v) override { scalar(v); }
+  void serialize_cstr(const char* v) override { value(); m_size += Model::string(std::strlen(v)); }
+  void serialize_bytes(const void*, size_t len) override { value(); m_size += Model::bytes(len); }
+
+  // Optional //////////////////////////////////////////////////////////////////
+  void serialize_none() override { value(); m_size += Model::none(); }
+  void serialize_some() override { m_size += Model::some(); }
+
+  // Sequence //////////////////////////////////////////////////////////////////
+  void serialize_seq_begin() override { value(); m_frames.push_back({Frame::Seq, 0}); }
+  void serialize_seq_end() override { m_size += Model::seq(m_frames.back().count); m_frames.pop_back(); }
+
+  // Map ///////////////////////////////////////////////////////////////////////
+  void serialize_map_begin() override { value(); m_frames.push_back({Frame::Map, 0}); }
+  void serialize_map_end() override { m_size += Model::map(m_frames.back().count); m_frames.pop_back(); }
+  void serialize_map_key_begin() override { m_frames.back().count++; m_size += Model::entry(); }
+  void serialize_map_key_end() override {}
+  void serialize_map_value_begin() override {}
+  void serialize_map_value_end() override {}
+
+  // Struct ////////////////////////////////////////////////////////////////////
+  void serialize_struct_begin() override { value(); m_frames.push_back({Frame::Struct, 0}); m_size += Model::structure(); }
+  void serialize_struct_end() override { m_frames.pop_back(); }
+  void serialize_struct_field_begin(const char* name) override { m_size += Model::field(name); }
+  void serialize_struct_field_end() override {}
+
+private:
+  // Open container, counting its elements or entries for Model::seq/map at its end
+  struct Frame {
+    enum Kind { Seq, Map, Struct } kind;
+    size_t count;
+  };
+
+  // A value starts, an element when directly in a sequence
+  void value() {
+    if (!m_frames.empty() && m_frames.back().kind == Frame::Seq) {
+      m_frames.back().count++;
+      m_size += Model::element();
+    }
+  }
+
+  template<typename T>
+  void scalar(T v) {
+    value();
+    m_size += Model::scalar(v);
+  }
+
+  size_t m_size = 0;
+  std::vector<Frame> m_frames;
+};
+
+} // namespace serde
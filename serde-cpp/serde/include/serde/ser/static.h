@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include "serialize.h"
+#include "serializer.h"
+#include "traits.h"
+
+namespace serde {
+
+// Serialization with static dispatch to a concrete serializer type S.
+// Calls are qualified with S so they are resolved at compile time and can be inlined,
+// instead of going through the virtual Serializer interface.
+// Scalars and types with a generated Serialize<T>::serialize_static<S> (serde_gen --static_dispatch)
+// are dispatched statically, any other type falls back to the virtual Serializer::serialize.
+template<typename S, typename T>
+inline void serialize_static(S& ser, const T& val) {
+  static_assert(std::is_base_of_v<Serializer, S>, "S must implement serde::Serializer");
+  if constexpr (traits::HasStaticSerialize<T, S>::value) {
+    Serialize<T>::template serialize_static<S>(ser, val);
+  }
+  else if constexpr (std::is_same_v<T, bool>) {
+    ser.S::serialize_bool(val);
+  }
+  else if constexpr (std::is_same_v<T, char> || std::is_same_v<T, signed char>) {
+    ser.S::serialize_char(val);
+  }
+  else if constexpr (std::is_same_v<T, unsigned char>) {
+    ser.S::serialize_uchar(val);
+  }
+  else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+    if constexpr (sizeof(T) == 2) ser.S::serialize_i16(val);
+    else if constexpr (sizeof(T) == 4) ser.S::serialize_i32(val);
+    else if constexpr (sizeof(T) == 8) ser.S::serialize_i64(val);
+    else static_assert(sizeof(T) <= 8, "unsupported signed integer size");
+  }
+  else if constexpr (std::is_integral_v<T> && std::is_unsigned_v<T>) {
+    if constexpr (sizeof(T) == 2) ser.S::serialize_u16(val);
+    else if constexpr (sizeof(T) == 4) ser.S::serialize_u32(val);
+    else if constexpr (sizeof(T) == 8) ser.S::serialize_u64(val);
+    else static_assert(sizeof(T) <= 8, "unsupported unsigned integer size");
+  }
+  else if constexpr (std::is_same_v<T, float>) {
+    ser.S::serialize_float(val);
+  }
+  else if constexpr (std::is_same_v<T, double>) {
+    ser.S::serialize_double(val);
+  }
+  else {
+    static_cast<Serializer&>(ser).serialize(val);
+  }
+}
+
+} // namespace serde
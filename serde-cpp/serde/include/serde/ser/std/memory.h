@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <typeinfo>
 #include "../serialize.h"
 #include "../serializer.h"
 
@@ -10,8 +11,10 @@ template<>
 struct SerializeT<std::unique_ptr> {
   template<typename T, typename Deleter>
   static void serialize(Serializer& ser, const std::unique_ptr<T, Deleter>& val) {
-    if (val)
+    if (val) {
+      ser.serialize_some();
       ser.serialize(*val);
+    }
     else
       ser.serialize_none();
   }
@@ -21,10 +24,15 @@ template<>
 struct SerializeT<std::shared_ptr> {
   template<typename T>
   static void serialize(Serializer& ser, const std::shared_ptr<T>& val) {
-    if (val)
-      ser.serialize(*val);
-    else
+    if (!val) {
       ser.serialize_none();
+      return;
+    }
+    ser.serialize_some();
+    if (!ser.serialize_shared_begin(val.get(), typeid(T))) {
+      ser.serialize(*val);
+      ser.serialize_shared_end();
+    }
   }
 };
 
@@ -10,8 +10,10 @@ template<>
 struct SerializeT<std::optional> {
   template<typename T>
   static void serialize(Serializer& ser, const std::optional<T>& opt) {
-    if (opt)
+    if (opt) {
+      ser.serialize_some();
       ser.serialize(*opt);
+    }
     else
       ser.serialize_none();
   }
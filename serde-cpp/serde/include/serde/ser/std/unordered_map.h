@@ -11,6 +11,7 @@ struct SerializeT<std::unordered_map> {
   template<typename Key, typename Value, typename... U>
   static void serialize(Serializer& ser, const std::unordered_map<Key, Value, U...>& map) {
     ser.serialize_map_begin();
+    ser.serialize_unordered();
     for (auto& it : map)
       ser.serialize_map_entry(it.first, it.second);
     ser.serialize_map_end();
@@ -22,6 +23,7 @@ struct SerializeT<std::unordered_multimap> {
   template<typename Key, typename Value, typename... U>
   static void serialize(Serializer& ser, const std::unordered_multimap<Key, Value, U...>& multimap) {
     ser.serialize_map_begin();
+    ser.serialize_unordered();
     for (auto& it : multimap)
       ser.serialize_map_entry(it.first, it.second);
     ser.serialize_map_end();
@@ -11,6 +11,7 @@ struct SerializeT<std::unordered_set> {
   template<typename Key, typename... U>
   static void serialize(Serializer& ser, const std::unordered_set<Key, U...>& set) {
     ser.serialize_seq_begin();
+    ser.serialize_unordered();
     for (auto& e : set)
       ser.serialize(e);
     ser.serialize_seq_end();
@@ -22,6 +23,7 @@ struct SerializeT<std::unordered_multiset> {
   template<typename Key, typename... U>
   static void serialize(Serializer& ser, const std::unordered_multiset<Key, U...>& multiset) {
     ser.serialize_seq_begin();
+    ser.serialize_unordered();
     for (auto& e : multiset)
       ser.serialize(e);
     ser.serialize_seq_end();
@@ -35,4 +35,24 @@ template<typename T>
 struct HasSerialize<T, std::enable_if_t<std::is_invocable_r_v<void, decltype(&Serialize<T, void>::serialize), Serializer&, const T&>>>
 : public std::true_type {};
 
+
+// Trait for detecting whether T has Serialize<T, void>::serialize_static<S> static function,
+// generated by serde_gen for statically dispatching calls to a concrete serializer S
+template<typename T, typename S, typename = void>
+struct HasStaticSerialize : public std::false_type {};
+
+template<typename T, typename S>
+struct HasStaticSerialize<T, S, std::void_t<decltype(&Serialize<T, void>::template serialize_static<S>)>>
+: public std::true_type {};
+
+
+// Trait for detecting whether T has Serialize<T, void>::serialized_size<Model> static function,
+// generated by serde_gen for computing the encoded size of T in a size Model
+template<typename T, typename Model, typename = void>
+struct HasSizedSerialize : public std::false_type {};
+
+template<typename T, typename Model>
+struct HasSizedSerialize<T, Model, std::void_t<decltype(&Serialize<T, void>::template serialized_size<Model>)>>
+: public std::true_type {};
+
 } // namespace serde::traits
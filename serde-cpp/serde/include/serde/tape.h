@@ -0,0 +1,506 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+#include "ser/serializer.h"
+#include "de/deserializer.h"
+#include "de/allocator.h"
+#include "error.h"
+#include "result.hpp"
+
+namespace serde {
+
+////////////////////////////////////////////////////////////////////////////////
+/// Tape
+///
+/// In-memory encoding of the Serializer calls for a value, to deserialize it
+/// again without formatting or parsing text: TapeSerializer records a value
+/// into a Tape and TapeDeserializer reads it back into the same or another,
+/// structurally compatible type. This backs serde::clone and serde::convert.
+///
+/// Nodes are laid out in pre-order, each container followed by its children,
+/// and know the index after their subtree to be skipped over. Maps hold their
+/// keys and values alternately, structs are maps keyed by field name.
+/// Integers are widened to 64 bits and floats to double, so they read back
+/// into any type that holds their value. Objects of a std::shared_ptr seen
+/// again are recorded as a reference to their first node, keeping sharing.
+/// A present optional or pointer is a Some node wrapping its value, so that an
+/// empty optional inside a present one reads back as such.
+class Tape {
+public:
+  struct Node {
+    enum Kind : uint8_t { Null, Bool, Int, UInt, Float, Str, Bytes, Seq, Map, Ref, Some } kind;
+    uint32_t next;  // index of the node after this subtree
+    uint64_t size;  // elements of Seq, entries of Map, length of Str and Bytes
+    union {
+      int64_t i;
+      uint64_t u;   // also offset in text of Str and Bytes, node index of Ref
+      double f;
+    };
+  };
+
+  std::vector<Node> nodes;
+  std::string text; // characters of Str and bytes of Bytes
+
+  void clear() {
+    nodes.clear();
+    text.clear();
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Serializer recording into a Tape
+class TapeSerializer final : public Serializer {
+public:
+  explicit TapeSerializer(Tape& tape) : m_tape(tape) {}
+
+  // Scalars ///////////////////////////////////////////////////////////////////
+  void serialize_bool(bool v) override { push(Tape::Node::Bool).u = v; }
+  void serialize_i8(int8_t v) override { push(Tape::Node::Int).i = v; }
+  void serialize_u8(uint8_t v) override { push(Tape::Node::UInt).u = v; }
+  void serialize_i16(int16_t v) override { push(Tape::Node::Int).i = v; }
+  void serialize_u16(uint16_t v) override { push(Tape::Node::UInt).u = v; }
+  void serialize_i32(int32_t v) override { push(Tape::Node::Int).i = v; }
+  void serialize_u32(uint32_t v) override { push(Tape::Node::UInt).u = v; }
+  void serialize_i64(int64_t v) override { push(Tape::Node::Int).i = v; }
+  void serialize_u64(uint64_t v) override { push(Tape::Node::UInt).u = v; }
+  void serialize_float(float v) override { push(Tape::Node::Float).f = v; }
+  void serialize_double(double v) override { push(Tape::Node::Float).f = v; }
+  void serialize_char(char v) override { push(Tape::Node::Int).i = v; }
+  void serialize_uchar(unsigned char v) override { push(Tape::Node::UInt).u = v; }
+  void serialize_cstr(const char* v) override { text(Tape::Node::Str, v, std::strlen(v)); }
+  void serialize_bytes(const void* v, size_t len) override { text(Tape::Node::Bytes, v, len); }
+
+  // Optional //////////////////////////////////////////////////////////////////
+  void serialize_none() override { push(Tape::Node::Null).u = 0; }
+  // the next value is the one element of the Some node, its end known once the value is
+  void serialize_some() override {
+    const auto index = static_cast<uint32_t>(m_tape.nodes.size());
+    auto& node = m_tape.nodes.emplace_back();
+    node.kind = Tape::Node::Some;
+    node.next = index + 1;
+    node.size = 1;
+    node.u = 0;
+    m_some.push_back({index, m_open.size()});
+  }
+
+  // Shared ////////////////////////////////////////////////////////////////////
+  bool serialize_shared_begin(const void* ptr, const std::type_info& type) override {
+    const auto index = static_cast<uint32_t>(m_tape.nodes.size());
+    auto [it, first] = m_shared.emplace(std::make_pair(ptr, std::type_index(type)), index);
+    if (first)
+      return false;
+    push(Tape::Node::Ref).u = it->second;
+    return true;
+  }
+
+  // Sequence //////////////////////////////////////////////////////////////////
+  void serialize_seq_begin() override { open(Tape::Node::Seq); }
+  void serialize_seq_end() override { close(); }
+
+  // Map ///////////////////////////////////////////////////////////////////////
+  void serialize_map_begin() override { open(Tape::Node::Map); }
+  void serialize_map_end() override { close(); }
+  void serialize_map_key_begin() override { m_tape.nodes[m_open.back()].size++; }
+  void serialize_map_key_end() override {}
+  void serialize_map_value_begin() override {}
+  void serialize_map_value_end() override {}
+
+  // Struct ////////////////////////////////////////////////////////////////////
+  void serialize_struct_begin() override { open(Tape::Node::Map); }
+  void serialize_struct_end() override { close(); }
+  void serialize_struct_field_begin(const char* name) override {
+    m_tape.nodes[m_open.back()].size++;
+    serialize_cstr(name);
+  }
+  void serialize_struct_field_end() override {}
+
+private:
+  // Appends the node of a value, an element when directly in a sequence
+  Tape::Node& push(Tape::Node::Kind kind) {
+    if (!m_open.empty() && m_tape.nodes[m_open.back()].kind == Tape::Node::Seq)
+      m_tape.nodes[m_open.back()].size++;
+    const auto index = static_cast<uint32_t>(m_tape.nodes.size());
+    auto& node = m_tape.nodes.emplace_back();
+    node.kind = kind;
+    node.next = index + 1;
+    node.size = 0;
+    if (kind != Tape::Node::Seq && kind != Tape::Node::Map)
+      end_some();
+    return node;
+  }
+
+  // Ends the Some nodes whose value was just completed
+  void end_some() {
+    while (!m_some.empty() && m_some.back().depth == m_open.size()) {
+      m_tape.nodes[m_some.back().index].next = static_cast<uint32_t>(m_tape.nodes.size());
+      m_some.pop_back();
+    }
+  }
+
+  void text(Tape::Node::Kind kind, const void* data, size_t len) {
+    auto& node = push(kind);
+    node.size = len;
+    node.u = m_tape.text.size();
+    m_tape.text.append(static_cast<const char*>(data), len);
+  }
+
+  void open(Tape::Node::Kind kind) {
+    push(kind).u = 0;
+    m_open.push_back(static_cast<uint32_t>(m_tape.nodes.size() - 1));
+  }
+
+  void close() {
+    m_tape.nodes[m_open.back()].next = static_cast<uint32_t>(m_tape.nodes.size());
+    m_open.pop_back();
+    end_some();
+  }
+
+  struct PendingSome {
+    uint32_t index;
+    size_t depth; // open containers when the Some node was pushed
+  };
+
+  Tape& m_tape;
+  std::vector<uint32_t> m_open;
+  std::vector<PendingSome> m_some;
+  std::map<std::pair<const void*, std::type_index>, uint32_t> m_shared;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Deserializer reading a Tape.
+/// Struct fields are found by name, those missing from the tape are left empty.
+/// The first mismatch between the tape and the type is kept in error(),
+/// after which the rest of the value is left empty.
+class TapeDeserializer final : public Deserializer {
+public:
+  explicit TapeDeserializer(const Tape& tape) : m_tape(tape) {}
+
+  const std::optional<Error>& error() const { return m_error; }
+
+  // Scalars ///////////////////////////////////////////////////////////////////
+  void deserialize_bool(bool& v) override {
+    if (auto node = scalar(Tape::Node::Bool)) v = node->u != 0;
+  }
+  void deserialize_i8(int8_t& v) override { integer(v); }
+  void deserialize_u8(uint8_t& v) override { integer(v); }
+  void deserialize_i16(int16_t& v) override { integer(v); }
+  void deserialize_u16(uint16_t& v) override { integer(v); }
+  void deserialize_i32(int32_t& v) override { integer(v); }
+  void deserialize_u32(uint32_t& v) override { integer(v); }
+  void deserialize_i64(int64_t& v) override { integer(v); }
+  void deserialize_u64(uint64_t& v) override { integer(v); }
+  void deserialize_float(float& v) override { floating(v); }
+  void deserialize_double(double& v) override { floating(v); }
+  void deserialize_char(char& v) override { integer(v); }
+  void deserialize_uchar(unsigned char& v) override { integer(v); }
+  void deserialize_cstr(char* val, size_t len) override {
+    if (auto node = scalar(Tape::Node::Str)) {
+      len = std::min<size_t>(node->size + 1, len);
+      if (len) {
+        std::memcpy(val, m_tape.text.data() + node->u, len - 1);
+        val[len - 1] = '\0';
+      }
+    }
+  }
+  void deserialize_bytes(void* val, size_t len) override {
+    if (auto node = scalar(Tape::Node::Bytes))
+      std::memcpy(val, m_tape.text.data() + node->u, std::min<size_t>(node->size, len));
+  }
+  // length of a string or of bytes
+  void deserialize_length(size_t& len) override {
+    len = 0;
+    if (auto node = peek(); node && (node->kind == Tape::Node::Str || node->kind == Tape::Node::Bytes))
+      len = node->size;
+  }
+
+  // Optional //////////////////////////////////////////////////////////////////
+  void deserialize_is_some(bool& some) override {
+    some = !skipping() && m_pos < m_tape.nodes.size() && m_tape.nodes[m_pos].kind != Tape::Node::Null;
+    if (some && m_tape.nodes[m_pos].kind == Tape::Node::Some)
+      m_pos++; // into the value, which may be none itself
+  }
+  void deserialize_none() override { scalar(Tape::Node::Null); }
+
+  // Kind //////////////////////////////////////////////////////////////////////
+  ValueKind deserialize_kind() override {
+    if (skipping() || m_pos >= m_tape.nodes.size())
+      return ValueKind::Null; // read as none, which is a no-op past an error
+    switch (peek()->kind) {
+      case Tape::Node::Null: return ValueKind::Null;
+      case Tape::Node::Bool: return ValueKind::Bool;
+      case Tape::Node::Int: return ValueKind::Int;
+      case Tape::Node::UInt: return ValueKind::UInt;
+      case Tape::Node::Float: return ValueKind::Float;
+      case Tape::Node::Str: return ValueKind::Str;
+      case Tape::Node::Bytes: return ValueKind::Bytes;
+      case Tape::Node::Seq: return ValueKind::Seq;
+      case Tape::Node::Map: return ValueKind::Map;
+      case Tape::Node::Ref: case Tape::Node::Some: break; // followed by peek
+    }
+    return ValueKind::Unknown;
+  }
+
+  // Shared ////////////////////////////////////////////////////////////////////
+  std::shared_ptr<void> deserialize_shared_find(const std::type_info& type) override {
+    if (skipping() || m_pos >= m_tape.nodes.size())
+      return nullptr;
+    const auto& node = m_tape.nodes[m_pos];
+    if (node.kind != Tape::Node::Ref) {
+      m_shared_at = m_pos;
+      return nullptr;
+    }
+    auto it = m_shared.find(node.u);
+    if (it == m_shared.end()) {
+      m_shared_at = node.u; // the first node was read into another kind of object, copy it
+      return nullptr;
+    }
+    if (*it->second.second != type) {
+      fail("shared object of another type");
+      return nullptr;
+    }
+    advance(m_pos + 1);
+    return it->second.first;
+  }
+  void deserialize_shared_insert(const std::shared_ptr<void>& obj, const std::type_info& type) override {
+    if (!skipping())
+      m_shared[m_shared_at] = {obj, &type};
+  }
+
+  // Sequence //////////////////////////////////////////////////////////////////
+  void deserialize_seq_begin() override { open(Tape::Node::Seq); }
+  void deserialize_seq_size(size_t& size) override { size = count(Tape::Node::Seq); }
+  void deserialize_seq_end() override { close(); }
+
+  // Map ///////////////////////////////////////////////////////////////////////
+  void deserialize_map_begin() override { open(Tape::Node::Map); }
+  void deserialize_map_size(size_t& size) override { size = count(Tape::Node::Map); }
+  void deserialize_map_end() override { close(); }
+  void deserialize_map_key_begin() override {}
+  void deserialize_map_key_end() override {}
+  void deserialize_map_key_find(const char* key) override { find(key); }
+  void deserialize_map_value_begin() override {}
+  void deserialize_map_value_end() override {}
+
+  // Struct ////////////////////////////////////////////////////////////////////
+  void deserialize_struct_begin() override { open(Tape::Node::Map); }
+  void deserialize_struct_end() override { close(); }
+  void deserialize_struct_field_begin(const char* name) override { find(name); }
+  void deserialize_struct_field_end() override {
+    if (m_missing)
+      m_missing--;
+  }
+
+private:
+  // Values of a Ref are read from its first node, then reading resumes after the Ref
+  struct Jump {
+    size_t resume;
+    size_t end;
+    size_t depth;
+  };
+
+  bool skipping() const { return m_missing || m_error; }
+
+  void fail(std::string text) {
+    if (!m_error)
+      m_error = Error{Error::Kind::Invalid, 0, 0, std::move(text) + " at node " + std::to_string(m_pos)};
+  }
+
+  // node of the next value, following references
+  const Tape::Node* peek() {
+    if (skipping())
+      return nullptr;
+    if (m_pos >= m_tape.nodes.size()) {
+      fail("end of tape");
+      return nullptr;
+    }
+    // values read as anything but an optional pass through their Some nodes
+    while (m_tape.nodes[m_pos].kind == Tape::Node::Ref || m_tape.nodes[m_pos].kind == Tape::Node::Some) {
+      if (m_tape.nodes[m_pos].kind == Tape::Node::Some) {
+        m_pos++;
+        continue;
+      }
+      const auto target = m_tape.nodes[m_pos].u;
+      m_jumps.push_back({m_pos + 1, m_tape.nodes[target].next, m_open.size()});
+      m_pos = target;
+    }
+    return &m_tape.nodes[m_pos];
+  }
+
+  void advance(size_t pos) {
+    m_pos = pos;
+    while (!m_jumps.empty() && m_jumps.back().depth == m_open.size() && m_jumps.back().end == m_pos) {
+      m_pos = m_jumps.back().resume;
+      m_jumps.pop_back();
+    }
+  }
+
+  const Tape::Node* scalar(Tape::Node::Kind kind) {
+    auto node = peek();
+    if (!node)
+      return nullptr;
+    if (node->kind != kind) {
+      fail("unexpected kind of value");
+      return nullptr;
+    }
+    advance(m_pos + 1);
+    return node;
+  }
+
+  template<typename T>
+  void integer(T& v) {
+    auto node = peek();
+    if (!node)
+      return;
+    bool fits = false;
+    if (node->kind == Tape::Node::Int) {
+      fits = std::is_signed_v<T> ? node->i >= static_cast<int64_t>(std::numeric_limits<T>::min())
+                                       && node->i <= static_cast<int64_t>(std::numeric_limits<T>::max())
+                                 : node->i >= 0 && static_cast<uint64_t>(node->i) <= std::numeric_limits<T>::max();
+      v = static_cast<T>(node->i);
+    }
+    else if (node->kind == Tape::Node::UInt) {
+      fits = node->u <= static_cast<uint64_t>(std::numeric_limits<T>::max());
+      v = static_cast<T>(node->u);
+    }
+    if (!fits) {
+      fail(node->kind == Tape::Node::Int || node->kind == Tape::Node::UInt ? "integer out of range"
+                                                                           : "unexpected kind of value");
+      return;
+    }
+    advance(m_pos + 1);
+  }
+
+  template<typename T>
+  void floating(T& v) {
+    auto node = peek();
+    if (!node)
+      return;
+    switch (node->kind) {
+      case Tape::Node::Float:
+        // a finite double beyond the range of a float would become an infinity
+        if (std::isfinite(node->f) && std::fabs(node->f) > std::numeric_limits<T>::max()) {
+          fail("floating point out of range");
+          return;
+        }
+        v = static_cast<T>(node->f);
+        break;
+      case Tape::Node::Int: v = static_cast<T>(node->i); break;
+      case Tape::Node::UInt: v = static_cast<T>(node->u); break;
+      default: fail("unexpected kind of value"); return;
+    }
+    advance(m_pos + 1);
+  }
+
+  size_t count(Tape::Node::Kind kind) {
+    auto node = peek();
+    if (!node)
+      return 0;
+    if (node->kind != kind) {
+      fail(kind == Tape::Node::Seq ? "expected a sequence" : "expected a map");
+      return 0;
+    }
+    return node->size;
+  }
+
+  void open(Tape::Node::Kind kind) {
+    auto node = peek();
+    if (!node)
+      return;
+    if (node->kind != kind) {
+      fail(kind == Tape::Node::Seq ? "expected a sequence" : "expected a map");
+      return;
+    }
+    m_open.push_back(m_pos);
+    m_pos++;
+  }
+
+  void close() {
+    if (skipping() || m_open.empty())
+      return;
+    const auto next = m_tape.nodes[m_open.back()].next;
+    m_open.pop_back();
+    advance(next);
+  }
+
+  // moves to the value of key in the innermost map, searching from the current entry on
+  void find(const char* key) {
+    if (m_missing) {
+      m_missing++;
+      return;
+    }
+    if (skipping())
+      return;
+    if (m_open.empty() || m_tape.nodes[m_open.back()].kind != Tape::Node::Map) {
+      fail("no map to find key");
+      return;
+    }
+    const std::string_view name(key);
+    const size_t first = m_open.back() + 1, end = m_tape.nodes[m_open.back()].next;
+    const auto search = [&](size_t from, size_t to) {
+      for (size_t k = from; k < to; k = m_tape.nodes[k + 1].next) {
+        const auto& node = m_tape.nodes[k];
+        if (node.kind == Tape::Node::Str && std::string_view(m_tape.text.data() + node.u, node.size) == name) {
+          m_pos = k + 1;
+          return true;
+        }
+      }
+      return false;
+    };
+    if (!search(std::min(m_pos, end), end) && !search(first, std::min(m_pos, end)))
+      m_missing = 1;
+  }
+
+  const Tape& m_tape;
+  size_t m_pos = 0;
+  std::vector<size_t> m_open;
+  std::vector<Jump> m_jumps;
+  size_t m_missing = 0; // depth of struct fields not in the tape
+  std::optional<Error> m_error;
+  size_t m_shared_at = 0;
+  std::map<size_t, std::pair<std::shared_ptr<void>, const std::type_info*>> m_shared;
+};
+
+/// Deep copy of obj through its serialization, without text
+template<typename T>
+T clone(const T& obj)
+{
+  Tape tape;
+  TapeSerializer ser(tape);
+  ser.serialize(obj);
+  TapeDeserializer de(tape);
+  T copy = make_default<T>(de);
+  de.deserialize(copy);
+  return copy;
+}
+
+/// Conversion of obj to a structurally compatible type U through their serialization, without text.
+/// Fails on the first value of obj that does not fit in U.
+template<typename U, typename T>
+auto convert(const T& obj) -> cpp::result<U, Error>
+{
+  Tape tape;
+  TapeSerializer ser(tape);
+  ser.serialize(obj);
+  TapeDeserializer de(tape);
+  U out = make_default<U>(de);
+  de.deserialize(out);
+  if (de.error())
+    return cpp::fail(*de.error());
+  return std::move(out);
+}
+
+} // namespace serde
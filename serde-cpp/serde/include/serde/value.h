@@ -0,0 +1,403 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "ser/serializer.h"
+#include "de/deserializer.h"
+
+namespace serde {
+
+////////////////////////////////////////////////////////////////////////////////
+/// Value
+///
+/// Document of any data, for payloads without a C++ type: null, bool, integers,
+/// double, strings, bytes, sequences and maps with string keys.
+///
+/// Nodes live in one vector in pre-order, each container followed by its children
+/// and knowing the index after its subtree, so building a Value allocates per growth
+/// of that vector rather than per node, and traversing it is a linear scan.
+/// Strings and bytes share one text buffer, map keys are interned once per Value.
+/// Value::Ref is a view of one node, valid until the Value changes.
+///
+/// Values are built from single nodes (Value::from_int(1), Value::seq(), ...) with
+/// push and insert appending copies of other Values to a Seq or Map.
+///
+/// A Value deserializes from formats that tell the kind of the next value
+/// (Deserializer::deserialize_kind) and serializes into any format, and with
+/// serde::convert an object converts to a Value and back.
+class Value {
+public:
+  using Kind = ValueKind;
+  class Ref;
+
+  Value() = default;
+
+  // Builders //////////////////////////////////////////////////////////////////
+  static Value null() { return scalar(Kind::Null); }
+  static Value from_bool(bool v) { Value val = scalar(Kind::Bool); val.m_nodes[0].b = v; return val; }
+  static Value from_int(int64_t v) { Value val = scalar(Kind::Int); val.m_nodes[0].i = v; return val; }
+  static Value from_uint(uint64_t v) { Value val = scalar(Kind::UInt); val.m_nodes[0].u = v; return val; }
+  static Value from_double(double v) { Value val = scalar(Kind::Float); val.m_nodes[0].f = v; return val; }
+  static Value from_string(std::string_view v) { return blob(Kind::Str, v.data(), v.size()); }
+  static Value from_bytes(const void* data, size_t len) { return blob(Kind::Bytes, data, len); }
+  /// Empty Seq, see push
+  static Value seq() { return scalar(Kind::Seq); }
+  /// Empty Map, see insert
+  static Value map() { return scalar(Kind::Map); }
+
+  /// Appends a copy of element to this Seq, an empty Value becomes a Seq first
+  Value& push(const Value& element) {
+    append(Kind::Seq, element, std::nullopt);
+    return *this;
+  }
+
+  /// Appends a copy of value with the given key to this Map, an empty Value becomes a Map
+  /// first. Keys are not checked for duplicates, find returns the first entry of a key.
+  Value& insert(std::string_view key, const Value& value) {
+    append(Kind::Map, value, std::string(key));
+    return *this;
+  }
+
+  /// Root node, Null for an empty Value
+  Ref root() const;
+  Kind kind() const;
+  size_t size() const;
+  Ref operator[](size_t index) const;
+  std::optional<Ref> find(std::string_view key) const;
+
+  bool empty() const { return m_nodes.empty(); }
+  void clear() {
+    m_nodes.clear();
+    m_text.clear();
+    m_keys.clear();
+  }
+
+  void serialize(Serializer& ser) const {
+    if (m_nodes.empty())
+      ser.serialize_none();
+    else
+      write(ser, 0);
+  }
+
+  void deserialize(Deserializer& de) {
+    clear();
+    Interned interned;
+    read(de, kNoKey, interned);
+  }
+
+private:
+  static constexpr uint32_t kNoKey = ~uint32_t{0};
+
+  struct Node {
+    Kind kind;
+    uint32_t key;   // index in m_keys of the key of a map entry, kNoKey otherwise
+    uint32_t next;  // index of the node after this subtree
+    uint32_t size;  // children of Seq and Map, length of Str and Bytes
+    union {
+      bool b;
+      int64_t i;
+      uint64_t u;   // also offset in m_text of Str and Bytes
+      double f;
+    };
+  };
+
+  using Interned = std::unordered_map<std::string, uint32_t>;
+
+  static Value scalar(Kind kind) {
+    Value val;
+    val.push(kind, kNoKey);
+    return val;
+  }
+
+  static Value blob(Kind kind, const void* data, size_t len) {
+    Value val = scalar(kind);
+    const size_t offset = val.text(len);
+    if (len)
+      std::memcpy(val.m_text.data() + offset, data, len);
+    val.m_nodes[0].u = offset;
+    val.m_nodes[0].size = static_cast<uint32_t>(len);
+    return val;
+  }
+
+  // Copies the nodes of child after the last child of the root, a container of the given kind
+  void append(Kind kind, const Value& child, std::optional<std::string> key) {
+    if (&child == this) {
+      const Value copy = child;
+      return append(kind, copy, std::move(key));
+    }
+    if (m_nodes.empty())
+      push(kind, kNoKey);
+    if (m_nodes[0].kind != kind)
+      throw std::logic_error(kind == Kind::Seq ? "Value::push on a Value that is not a Seq"
+                                               : "Value::insert on a Value that is not a Map");
+    const auto key_index = key ? static_cast<uint32_t>(m_keys.size()) : kNoKey;
+    if (key)
+      m_keys.push_back(std::move(*key));
+    const auto base = static_cast<uint32_t>(m_nodes.size());
+    const auto keys = static_cast<uint32_t>(m_keys.size());
+    const size_t text = m_text.size();
+    if (child.m_nodes.empty()) {
+      push(Kind::Null, key_index);
+    } else {
+      for (Node node : child.m_nodes) {
+        node.next += base;
+        if (node.key != kNoKey)
+          node.key += keys;
+        if (node.kind == Kind::Str || node.kind == Kind::Bytes)
+          node.u += text;
+        m_nodes.push_back(node);
+      }
+      m_nodes[base].key = key_index;
+      m_text += child.m_text;
+      m_keys.insert(m_keys.end(), child.m_keys.begin(), child.m_keys.end());
+    }
+    m_nodes[0].next = static_cast<uint32_t>(m_nodes.size());
+    m_nodes[0].size++;
+  }
+
+  uint32_t push(Kind kind, uint32_t key) {
+    const auto index = static_cast<uint32_t>(m_nodes.size());
+    Node& node = m_nodes.emplace_back();
+    node.kind = kind;
+    node.key = key;
+    node.next = index + 1;
+    node.size = 0;
+    node.u = 0;
+    return index;
+  }
+
+  // Reads the next value of de into a new node with the given key
+  void read(Deserializer& de, uint32_t key, Interned& interned) {
+    const Kind kind = de.deserialize_kind();
+    const auto index = push(kind == Kind::Unknown ? Kind::Str : kind, key);
+    size_t count = 0;
+    switch (kind) {
+      case Kind::Null: de.deserialize_none(); break;
+      case Kind::Bool: de.deserialize_bool(m_nodes[index].b); break;
+      case Kind::Int: de.deserialize_i64(m_nodes[index].i); break;
+      case Kind::UInt: de.deserialize_u64(m_nodes[index].u); break;
+      case Kind::Float: de.deserialize_double(m_nodes[index].f); break;
+      case Kind::Bytes: {
+        de.deserialize_length(count);
+        const size_t offset = text(count);
+        de.deserialize_bytes(m_text.data() + offset, count);
+        m_nodes[index].u = offset;
+        m_nodes[index].size = static_cast<uint32_t>(count);
+        break;
+      }
+      case Kind::Seq:
+        de.deserialize_seq_size(count);
+        de.deserialize_seq_begin();
+        for (size_t n = 0; n < count; n++)
+          read(de, kNoKey, interned);
+        de.deserialize_seq_end();
+        m_nodes[index].size = static_cast<uint32_t>(count);
+        break;
+      case Kind::Map:
+        de.deserialize_map_size(count);
+        de.deserialize_map_begin();
+        for (size_t n = 0; n < count; n++) {
+          de.deserialize_map_key_begin();
+          const auto entry_key = intern(read_key(de), interned);
+          de.deserialize_map_key_end();
+          de.deserialize_map_value_begin();
+          read(de, entry_key, interned);
+          de.deserialize_map_value_end();
+        }
+        de.deserialize_map_end();
+        m_nodes[index].size = static_cast<uint32_t>(count);
+        break;
+      default: { // strings, and anything of a format that cannot tell kinds
+        de.deserialize_length(count);
+        const size_t offset = text(count);
+        de.deserialize_cstr(m_text.data() + offset, count + 1);
+        m_nodes[index].u = offset;
+        m_nodes[index].size = static_cast<uint32_t>(count);
+        break;
+      }
+    }
+    m_nodes[index].next = static_cast<uint32_t>(m_nodes.size());
+  }
+
+  // Keys are kept as text, integers and booleans in their decimal and true/false forms
+  static std::string read_key(Deserializer& de) {
+    switch (de.deserialize_kind()) {
+      case Kind::Bool: { bool v = false; de.deserialize_bool(v); return v ? "true" : "false"; }
+      case Kind::Int: { int64_t v = 0; de.deserialize_i64(v); return std::to_string(v); }
+      case Kind::UInt: { uint64_t v = 0; de.deserialize_u64(v); return std::to_string(v); }
+      default: return read_string(de);
+    }
+  }
+
+  static std::string read_string(Deserializer& de) {
+    size_t len = 0;
+    de.deserialize_length_cstr(len);
+    std::string str(len, '\0');
+    de.deserialize_cstr(str.data(), len);
+    str.resize(len ? len - 1 : 0); // 0 when the format has no string there
+    return str;
+  }
+
+  uint32_t intern(std::string&& key, Interned& interned) {
+    auto [it, inserted] = interned.try_emplace(std::move(key), static_cast<uint32_t>(m_keys.size()));
+    if (inserted)
+      m_keys.push_back(it->first);
+    return it->second;
+  }
+
+  // Room for len characters at the end of the text, null-terminated so strings pass as C strings
+  size_t text(size_t len) {
+    const size_t offset = m_text.size();
+    m_text.resize(offset + len + 1);
+    return offset;
+  }
+
+  // Serializes the node at index, returns the index after its subtree
+  uint32_t write(Serializer& ser, uint32_t index) const {
+    const Node& node = m_nodes[index];
+    switch (node.kind) {
+      case Kind::Null: ser.serialize_none(); break;
+      case Kind::Bool: ser.serialize_bool(node.b); break;
+      case Kind::Int: ser.serialize_i64(node.i); break;
+      case Kind::UInt: ser.serialize_u64(node.u); break;
+      case Kind::Float: ser.serialize_double(node.f); break;
+      case Kind::Bytes: ser.serialize_bytes(m_text.data() + node.u, node.size); break;
+      case Kind::Seq:
+        ser.serialize_seq_begin();
+        for (uint32_t child = index + 1; child < node.next;)
+          child = write(ser, child);
+        ser.serialize_seq_end();
+        break;
+      case Kind::Map:
+        ser.serialize_map_begin();
+        for (uint32_t child = index + 1; child < node.next;) {
+          ser.serialize_map_key_begin();
+          ser.serialize_cstr(m_keys[m_nodes[child].key].c_str());
+          ser.serialize_map_key_end();
+          ser.serialize_map_value_begin();
+          child = write(ser, child);
+          ser.serialize_map_value_end();
+        }
+        ser.serialize_map_end();
+        break;
+      default: ser.serialize_cstr(m_text.data() + node.u); break;
+    }
+    return node.next;
+  }
+
+  std::vector<Node> m_nodes;
+  std::string m_text;
+  std::vector<std::string> m_keys;
+};
+
+/// View of a node of a Value. Scalar accessors convert between the numeric kinds
+/// and return a zero value for other kinds; containers iterate over their children.
+class Value::Ref {
+public:
+  Kind kind() const { return m_value ? node().kind : Kind::Null; }
+  bool is_null() const { return kind() == Kind::Null; }
+  bool is_seq() const { return kind() == Kind::Seq; }
+  bool is_map() const { return kind() == Kind::Map; }
+
+  bool as_bool() const { return kind() == Kind::Bool && node().b; }
+  int64_t as_int() const {
+    switch (kind()) {
+      case Kind::Int: return node().i;
+      case Kind::UInt: return static_cast<int64_t>(node().u);
+      case Kind::Float: return static_cast<int64_t>(node().f);
+      default: return 0;
+    }
+  }
+  uint64_t as_uint() const { return kind() == Kind::UInt ? node().u : static_cast<uint64_t>(as_int()); }
+  double as_double() const {
+    switch (kind()) {
+      case Kind::Int: return static_cast<double>(node().i);
+      case Kind::UInt: return static_cast<double>(node().u);
+      case Kind::Float: return node().f;
+      default: return 0;
+    }
+  }
+  /// Characters of a Str or bytes of a Bytes
+  std::string_view as_string() const {
+    if (kind() != Kind::Str && kind() != Kind::Bytes)
+      return {};
+    return {m_value->m_text.data() + node().u, node().size};
+  }
+
+  /// Key of a map entry, empty for other nodes
+  std::string_view key() const {
+    return m_value && node().key != kNoKey ? std::string_view(m_value->m_keys[node().key]) : std::string_view();
+  }
+
+  /// Children of a Seq or Map, 0 for other nodes
+  size_t size() const { return is_seq() || is_map() ? node().size : 0; }
+
+  class iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Ref;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Ref*;
+    using reference = Ref;
+
+    Ref operator*() const { return {m_value, m_index}; }
+    iterator& operator++() { m_index = m_value->m_nodes[m_index].next; return *this; }
+    iterator operator++(int) { auto it = *this; ++*this; return it; }
+    bool operator==(const iterator& o) const { return m_index == o.m_index; }
+    bool operator!=(const iterator& o) const { return m_index != o.m_index; }
+
+  private:
+    friend class Ref;
+    iterator(const Value* value, uint32_t index) : m_value(value), m_index(index) {}
+    const Value* m_value;
+    uint32_t m_index;
+  };
+
+  iterator begin() const { return {m_value, size() ? m_index + 1 : m_index}; }
+  iterator end() const { return {m_value, size() ? node().next : m_index}; }
+
+  /// Element at index of a Seq or entry of a Map, found by walking the siblings before it;
+  /// a Null Ref past the end
+  Ref operator[](size_t index) const {
+    if (index >= size())
+      return {};
+    auto it = begin();
+    while (index--)
+      ++it;
+    return *it;
+  }
+
+  /// Value of the entry of a Map with the given key
+  std::optional<Ref> find(std::string_view key) const {
+    if (!is_map())
+      return std::nullopt;
+    for (auto child : *this)
+      if (child.key() == key)
+        return child;
+    return std::nullopt;
+  }
+
+private:
+  friend class Value;
+  Ref() = default;
+  Ref(const Value* value, uint32_t index) : m_value(value), m_index(index) {}
+  const Node& node() const { return m_value->m_nodes[m_index]; }
+
+  const Value* m_value = nullptr;
+  uint32_t m_index = 0;
+};
+
+inline Value::Ref Value::root() const { return m_nodes.empty() ? Ref() : Ref(this, 0); }
+inline Value::Kind Value::kind() const { return root().kind(); }
+inline size_t Value::size() const { return root().size(); }
+inline Value::Ref Value::operator[](size_t index) const { return root()[index]; }
+inline std::optional<Value::Ref> Value::find(std::string_view key) const { return root().find(key); }
+
+} // namespace serde
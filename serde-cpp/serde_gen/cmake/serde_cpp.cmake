@@ -7,13 +7,27 @@ include(CMakeParseArguments)
 #   SUFFIX default: "_serde.h"
 #   OUTPUT_DIRECTORY default: "${CMAKE_CURRENT_BINARY_DIR}/"
 #   VERBOSE default: OFF
+#   STATIC_DISPATCH default: OFF
+#     also generate serialize_static<S>() for statically dispatching to a concrete serializer
+#   SERIALIZED_SIZE default: OFF
+#     also generate serialized_size<Model>() for computing the encoded size in a size model
+#   COLUMNS default: OFF
+#     also generate a struct-of-arrays companion <T>Columns, serialized as a sequence of T
+#   TIME_REPORT default: OFF
+#     print per-stage generation timings and entity counts of each source file
+#   TRACE default: OFF
+#     write a Chrome trace-event JSON of each source file next to its serde header,
+#     as "<header>.trace.json"
+#   SERVER default: "${SERDE_GEN_SERVER}"
+#     unix socket of a running `serde_gen --serve=<socket>`, generation falls back
+#     to a local serde_gen process when the server is not reachable.
 #########################################################################################
 function(serde_generate TARGET)
 
   # Parse arguments
   set(prefix ARG)
-  set(flags VERBOSE)
-  set(singleValues SUFFIX OUTPUT_DIRECTORY)
+  set(flags VERBOSE STATIC_DISPATCH SERIALIZED_SIZE COLUMNS TIME_REPORT TRACE)
+  set(singleValues SUFFIX OUTPUT_DIRECTORY SERVER)
   set(multiValues)
   cmake_parse_arguments(PARSE_ARGV 1 "${prefix}" "${flags}" "${singleValues}" "${multiValues}")
 
@@ -35,6 +49,30 @@ function(serde_generate TARGET)
     set(VERBOSE "--verbose")
   endif()
 
+  if(ARG_STATIC_DISPATCH)
+    set(STATIC_DISPATCH "--static_dispatch")
+  endif()
+
+  if(ARG_SERIALIZED_SIZE)
+    set(SERIALIZED_SIZE "--serialized_size")
+  endif()
+
+  if(ARG_COLUMNS)
+    set(COLUMNS "--columns")
+  endif()
+
+  if(ARG_TIME_REPORT)
+    set(TIME_REPORT "--time-report")
+  endif()
+
+  if(NOT DEFINED ARG_SERVER AND DEFINED SERDE_GEN_SERVER)
+    set(ARG_SERVER "${SERDE_GEN_SERVER}")
+  endif()
+
+  if(DEFINED ARG_SERVER AND NOT ARG_SERVER STREQUAL "")
+    set(CONNECT "--connect=${ARG_SERVER}")
+  endif()
+
   # Generate new list of serde header file names
   foreach(FILE IN LISTS ARG_SOURCES)
     # Get file absolute path
@@ -78,6 +116,10 @@ function(serde_generate TARGET)
   foreach(IDX RANGE ${MAX_IDX})
     list(GET SERDE_HEADERS ${IDX} SERDE_HEADER)
     list(GET SOURCES ${IDX} SOURCE)
+    set(TRACE)
+    if(ARG_TRACE)
+      set(TRACE "--trace=${SERDE_HEADER}.trace.json")
+    endif()
     add_custom_command(
       OUTPUT ${SERDE_HEADER}
       COMMAND $<TARGET_FILE:serde_cpp::serde_gen>
@@ -87,6 +129,12 @@ function(serde_generate TARGET)
                 --database_file=compile_commands.json
                 --include_directory=${ARG_OUTPUT_DIRECTORY}
                 ${VERBOSE}
+                ${STATIC_DISPATCH}
+                ${SERIALIZED_SIZE}
+                ${COLUMNS}
+                ${TIME_REPORT}
+                ${TRACE}
+                ${CONNECT}
       WORKING_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}
       DEPENDS serde_cpp::serde_gen ${SOURCE})
   endforeach()
@@ -1,5 +1,6 @@
 #include "common.h"
 
+#include <filesystem>
 #include <iostream>
 
 #include <cppast/code_generator.hpp>
@@ -31,6 +32,48 @@ auto parse_file(const cppast::libclang_compile_config& config,
     return file;
 }
 
+auto parse_file(ParseCache& cache, const cppast::libclang_compile_config& config,
+                const std::string& filename, bool fatal_error)
+    -> std::unique_ptr<cppast::cpp_file>
+{
+    cppast::cpp_entity_index idx;
+    // the parser keeps its libclang index alive, only the error flag is per file
+    auto& parser = cache.parser();
+    parser.reset_error();
+    auto file = parser.parse(idx, filename, config);
+    if (fatal_error && parser.error())
+        return nullptr;
+    return file;
+}
+
+auto ParseCache::database_config(const std::string& directory, const std::string& filename)
+    -> const cppast::libclang_compile_config&
+{
+    // a reconfigure rewrites the database, drop the configs loaded from an older one
+    std::error_code ec;
+    auto mtime = std::filesystem::last_write_time(
+        std::filesystem::path(directory) / "compile_commands.json", ec);
+    if (ec)
+        mtime = std::filesystem::file_time_type::min();
+    auto loaded = database_times_.find(directory);
+    if (loaded == database_times_.end() || loaded->second != mtime) {
+        auto first = configs_.lower_bound(std::make_pair(directory, std::string()));
+        auto last = first;
+        while (last != configs_.end() && last->first.first == directory)
+            ++last;
+        configs_.erase(first, last);
+        database_times_[directory] = mtime;
+    }
+
+    auto key = std::make_pair(directory, filename);
+    auto it = configs_.find(key);
+    if (it == configs_.end()) {
+        auto db = cppast::libclang_compilation_database(directory);
+        it = configs_.emplace(std::move(key), cppast::libclang_compile_config(db, filename)).first;
+    }
+    return it->second;
+}
+
 // prints the AST entry of a cpp_entity (base class for all entities),
 // will only print a single line
 void print_entity(std::ostream& out, const cppast::cpp_entity& e)
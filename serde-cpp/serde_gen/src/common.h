@@ -1,16 +1,48 @@
 #pragma once
 
+#include <filesystem>
+#include <map>
 #include <memory>
 #include <iostream>
+#include <utility>
 #include <cppast/cpp_entity.hpp>
+#include <cppast/diagnostic_logger.hpp>
+#include <cppast/libclang_parser.hpp>
 
 namespace serde_gen {
 
+// parser state kept alive across multiple files (e.g. generation server),
+// so libclang's index and the compilation databases are only loaded once
+class ParseCache {
+   public:
+    ParseCache() : parser_(type_safe::ref(logger_)) {}
+
+    cppast::stderr_diagnostic_logger& logger() noexcept { return logger_; }
+    cppast::libclang_parser& parser() noexcept { return parser_; }
+
+    // compile config for a file entry of the compilation database in directory,
+    // the database is loaded on first use and the resulting config is cached
+    // until the database file is modified
+    auto database_config(const std::string& directory, const std::string& filename)
+        -> const cppast::libclang_compile_config&;
+
+   private:
+    cppast::stderr_diagnostic_logger logger_;
+    cppast::libclang_parser parser_;
+    std::map<std::pair<std::string, std::string>, cppast::libclang_compile_config> configs_;
+    std::map<std::string, std::filesystem::file_time_type> database_times_;
+};
+
 // parse file
 auto parse_file(const cppast::libclang_compile_config& config,
                 const cppast::diagnostic_logger& logger, const std::string& filename,
                 bool fatal_error) -> std::unique_ptr<cppast::cpp_file>;
 
+// parse file reusing the parser of a cache
+auto parse_file(ParseCache& cache, const cppast::libclang_compile_config& config,
+                const std::string& filename, bool fatal_error)
+    -> std::unique_ptr<cppast::cpp_file>;
+
 // prints the AST entry of a cpp_entity (base class for all entities),
 // will only print a single line
 void print_entity(std::ostream& out, const cppast::cpp_entity& e);
@@ -224,6 +224,134 @@ struct ApiDeserializeStructField : public GenT<ApiDeserializeStructField> {
     }
 };
 
+struct ApiSerializeStaticStructField : public GenT<ApiSerializeStaticStructField> {
+    std::string key, value;
+    explicit ApiSerializeStaticStructField(const std::string& key, const std::string value)
+        : key(key), value(value)
+    {
+    }
+    explicit ApiSerializeStaticStructField(std::string&& key, std::string&& value)
+        : key(std::move(key)), value(std::move(value))
+    {
+    }
+    std::ostream& write(std::ostream& os, IoCtl& ctl) const override
+    {
+        os << "ser.S::serialize_struct_field_begin(\"" << key << "\");\n";
+        os << "serde::serialize_static(ser, val." << value << ");\n";
+        os << "ser.S::serialize_struct_field_end();\n";
+        return os;
+    }
+};
+
+struct ApiSerializedSizeStructField : public GenT<ApiSerializedSizeStructField> {
+    std::string key, value;
+    explicit ApiSerializedSizeStructField(const std::string& key, const std::string value)
+        : key(key), value(value)
+    {
+    }
+    explicit ApiSerializedSizeStructField(std::string&& key, std::string&& value)
+        : key(std::move(key)), value(std::move(value))
+    {
+    }
+    std::ostream& write(std::ostream& os, IoCtl& ctl) const override
+    {
+        os << "size += Model::field(\"" << key << "\") + serde::serialized_size<Model>(val." << value
+           << ");\n";
+        return os;
+    }
+};
+
+struct ColumnsBegin : public GenT<ColumnsBegin> {
+    std::string name;
+    explicit ColumnsBegin(std::string&& name) : name(std::move(name)) {}
+    std::ostream& write(std::ostream& os, IoCtl& ctl) const override
+    {
+        os << "template<typename T = " << name << ">\n";
+        os << "struct " << name << "ColumnsT {\n";
+        return os;
+    }
+};
+
+struct ColumnsField : public GenT<ColumnsField> {
+    std::string field;
+    explicit ColumnsField(const std::string& field) : field(field) {}
+    std::ostream& write(std::ostream& os, IoCtl& ctl) const override
+    {
+        os << "std::vector<decltype(T::" << field << ")> " << field << ";\n";
+        return os;
+    }
+};
+
+struct ColumnsSize : public GenT<ColumnsSize> {
+    std::string field;
+    explicit ColumnsSize(const std::string& field) : field(field) {}
+    std::ostream& write(std::ostream& os, IoCtl& ctl) const override
+    {
+        if (field.empty())
+            os << "size_t size() const { return 0; }\n";
+        else
+            os << "size_t size() const { return " << field << ".size(); }\n";
+        return os;
+    }
+};
+
+struct ColumnsEnd : public GenT<ColumnsEnd> {
+    std::string name;
+    explicit ColumnsEnd(std::string&& name) : name(std::move(name)) {}
+    std::ostream& write(std::ostream& os, IoCtl& ctl) const override
+    {
+        os << "};\n";
+        os << "using " << name << "Columns = " << name << "ColumnsT<>;\n";
+        ctl.indent_dec();
+        return os;
+    }
+};
+
+struct ApiSerializeColumnField : public GenT<ApiSerializeColumnField> {
+    std::string key, value;
+    explicit ApiSerializeColumnField(const std::string& key, const std::string value)
+        : key(key), value(value)
+    {
+    }
+    std::ostream& write(std::ostream& os, IoCtl& ctl) const override
+    {
+        os << "ser.serialize_struct_field(\"" << key << "\", val." << value << "[i]);\n";
+        return os;
+    }
+};
+
+struct ApiDeserializeColumnResize : public GenT<ApiDeserializeColumnResize> {
+    std::string value;
+    explicit ApiDeserializeColumnResize(const std::string& value) : value(value) {}
+    std::ostream& write(std::ostream& os, IoCtl& ctl) const override
+    {
+        os << "val." << value << ".resize(size);\n";
+        return os;
+    }
+};
+
+struct ApiDeserializeColumnField : public GenT<ApiDeserializeColumnField> {
+    std::string key, value;
+    explicit ApiDeserializeColumnField(const std::string& key, const std::string value)
+        : key(key), value(value)
+    {
+    }
+    std::ostream& write(std::ostream& os, IoCtl& ctl) const override
+    {
+        // std::vector<bool> elements are proxies, deserialize through a temporary;
+        // decided by the compiler so that aliases of bool are caught too
+        os << "if constexpr (std::is_same_v<typename decltype(val." << value << ")::value_type, bool>) {\n";
+        os << "bool " << value << " = val." << value << "[i];\n";
+        os << "de.deserialize_struct_field(\"" << key << "\", " << value << ");\n";
+        os << "val." << value << "[i] = " << value << ";\n";
+        os << "}\n";
+        os << "else {\n";
+        os << "de.deserialize_struct_field(\"" << key << "\", val." << value << "[i]);\n";
+        os << "}\n";
+        return os;
+    }
+};
+
 struct GenString : public GenT<GenString> {
     std::string string;
     explicit GenString(std::string&& string) : string(std::move(string)) {}
@@ -336,8 +464,35 @@ SIMPLE_GEN_TYPE(StaticMethodDeserializeBegin,
                 "static void deserialize(Deserializer& de, T& val) {\n");
 SIMPLE_GEN_TYPE(StaticMethodSerializeBegin,
                 "static void serialize(Serializer& ser, const T& val) {\n");
+SIMPLE_GEN_TYPE(StaticMethodSerializeStaticBegin,
+                "template<typename S>\nstatic void serialize_static(S& ser, const T& val) {\n");
+SIMPLE_GEN_TYPE(StaticMethodSerializedSizeBegin,
+                "template<typename Model>\nstatic size_t serialized_size(const T& val) {\n");
 SIMPLE_GEN_TYPE(ApiSerializeStructBegin, "ser.serialize_struct_begin();\n");
 SIMPLE_GEN_TYPE(ApiSerializeStructEnd, "ser.serialize_struct_end();\n");
+SIMPLE_GEN_TYPE(ApiSerializeStaticStructBegin, "ser.S::serialize_struct_begin();\n");
+SIMPLE_GEN_TYPE(ApiSerializeStaticStructEnd, "ser.S::serialize_struct_end();\n");
+SIMPLE_GEN_TYPE(ApiSerializedSizeStructBegin, "size_t size = Model::structure();\n");
+SIMPLE_GEN_TYPE(ApiSerializedSizeStructEnd, "return size;\n");
+SIMPLE_GEN_TYPE(ApiSerializeColumnsBegin,
+                "ser.serialize_seq_begin();\n"
+                "for (size_t i = 0; i < val.size(); i++) {\n"
+                "ser.serialize_struct_begin();\n");
+SIMPLE_GEN_TYPE(ApiSerializeColumnsEnd,
+                "ser.serialize_struct_end();\n"
+                "}\n"
+                "ser.serialize_seq_end();\n");
+SIMPLE_GEN_TYPE(ApiDeserializeColumnsBegin,
+                "size_t size = 0;\n"
+                "de.deserialize_seq_size(size);\n"
+                "de.deserialize_seq_begin();\n");
+SIMPLE_GEN_TYPE(ApiDeserializeColumnsLoopBegin,
+                "for (size_t i = 0; i < size; i++) {\n"
+                "de.deserialize_struct_begin();\n");
+SIMPLE_GEN_TYPE(ApiDeserializeColumnsEnd,
+                "de.deserialize_struct_end();\n"
+                "}\n"
+                "de.deserialize_seq_end();\n");
 SIMPLE_GEN_TYPE(ApiDeserializeStructBegin, "de.deserialize_struct_begin();\n");
 SIMPLE_GEN_TYPE(ApiDeserializeStructEnd, "de.deserialize_struct_end();\n");
 
@@ -18,7 +18,8 @@
 
 namespace serde_gen {
 
-void generate_serde_for_file(std::ostream& output, const cppast::cpp_file& file)
+void generate_serde_for_file(std::ostream& output, const cppast::cpp_file& file,
+                             const GenerateOptions& options, Profiler* profiler)
 {
     using namespace gen;
 
@@ -26,20 +27,42 @@ void generate_serde_for_file(std::ostream& output, const cppast::cpp_file& file)
     gen.add_header(FileHeader());
     gen.add_include_local("serde/serde.h");
     gen.add_include_local("serde/std/string.h");
+    if (options.columns)
+        gen.add_include_local("serde/std/vector.h");
+    if (options.serialized_size)
+        gen.add_include_local("serde/ser/size.h");
 
-    cppast::visit(file, Filter::cpp_entities_with_serde_attr, [&](const auto& e, const auto& info) {
-        generate_serde_for_entity(gen, e, info);
-    });
+    size_t visited = 0, serde_entities = 0;
+    {
+        auto stage = profile_stage(profiler, "visit");
+        auto filter = [&](const cppast::cpp_entity& e) {
+            visited++;
+            return Filter::cpp_entities_with_serde_attr(e);
+        };
+        cppast::visit(file, filter, [&](const auto& e, const auto& info) {
+            if (!info.is_old_entity())
+                serde_entities++;
+            generate_serde_for_entity(gen, e, info, options);
+        });
+    }
+
+    {
+        auto stage = profile_stage(profiler, "write");
+        gen.write(output);
+    }
 
-    gen.write(output);
+    if (profiler) {
+        profiler->add_count("visited", visited);
+        profiler->add_count("serde types", serde_entities);
+    }
 }
 
 void generate_serde_for_entity(gen::Generator& gen, const cppast::cpp_entity& e,
-                               const cppast::visitor_info& info)
+                               const cppast::visitor_info& info, const GenerateOptions& options)
 {
     if (e.kind() == cppast::cpp_entity_kind::class_t) {
         if (!info.is_old_entity()) {  // meaning: not visited yet
-            generate_serde_for_class(gen, e, info);
+            generate_serde_for_class(gen, e, info, options);
         }
     }
     else {
@@ -49,7 +72,7 @@ void generate_serde_for_entity(gen::Generator& gen, const cppast::cpp_entity& e,
 }
 
 void generate_serde_for_class(gen::Generator& gen, const cppast::cpp_entity& e,
-                              const cppast::visitor_info& info)
+                              const cppast::visitor_info& info, const GenerateOptions& options)
 {
     using namespace gen;
 
@@ -57,18 +80,27 @@ void generate_serde_for_class(gen::Generator& gen, const cppast::cpp_entity& e,
     gen.add(GenString(std::move(entity_decl)));  // forward-declaration
                                                  // TODO: support namespaces
     gen.add(LineBreak(2));
+
+    if (options.columns)
+        generate_columns(gen, e, info);
+
     gen.add(NamespaceBegin("serde"));
     gen.add(LineBreak());
 
-    generate_struct_serialize(gen, e, info);
+    generate_struct_serialize(gen, e, info, options);
     generate_struct_deserialize(gen, e, info);
 
+    if (options.columns) {
+        generate_columns_serialize(gen, e, info);
+        generate_columns_deserialize(gen, e, info);
+    }
+
     gen.add(NamespaceEnd("serde"));
     gen.add(LineBreak());
 }
 
 void generate_struct_serialize(gen::Generator& gen, const cppast::cpp_entity& e,
-                               const cppast::visitor_info& info)
+                               const cppast::visitor_info& info, const GenerateOptions& options)
 {
     using namespace gen;
 
@@ -87,10 +119,58 @@ void generate_struct_serialize(gen::Generator& gen, const cppast::cpp_entity& e,
 
     gen.add(ApiSerializeStructEnd());
     gen.add(StaticMethodSerializeEnd());
+
+    if (options.static_dispatch)
+        generate_method_serialize_static(gen, e, info);
+    if (options.serialized_size)
+        generate_method_serialized_size(gen, e, info);
+
     gen.add(StructSerializeEnd());
     gen.add(LineBreak());
 }
 
+void generate_method_serialize_static(gen::Generator& gen, const cppast::cpp_entity& e,
+                                      const cppast::visitor_info& info)
+{
+    using namespace gen;
+
+    const auto& cpp_class = static_cast<const cppast::cpp_class&>(e);
+
+    gen.add(StaticMethodSerializeStaticBegin());
+    gen.add(ApiSerializeStaticStructBegin());
+
+    for (const auto& member : cpp_class) {
+        if (member.kind() == cppast::cpp_entity_kind::member_variable_t) {
+            const auto& member_var = static_cast<const cppast::cpp_member_variable&>(member);
+            gen.add(ApiSerializeStaticStructField(member_var.name(), member_var.name()));
+        }
+    }
+
+    gen.add(ApiSerializeStaticStructEnd());
+    gen.add(StaticMethodSerializeEnd());
+}
+
+void generate_method_serialized_size(gen::Generator& gen, const cppast::cpp_entity& e,
+                                     const cppast::visitor_info& info)
+{
+    using namespace gen;
+
+    const auto& cpp_class = static_cast<const cppast::cpp_class&>(e);
+
+    gen.add(StaticMethodSerializedSizeBegin());
+    gen.add(ApiSerializedSizeStructBegin());
+
+    for (const auto& member : cpp_class) {
+        if (member.kind() == cppast::cpp_entity_kind::member_variable_t) {
+            const auto& member_var = static_cast<const cppast::cpp_member_variable&>(member);
+            gen.add(ApiSerializedSizeStructField(member_var.name(), member_var.name()));
+        }
+    }
+
+    gen.add(ApiSerializedSizeStructEnd());
+    gen.add(StaticMethodSerializeEnd());
+}
+
 void generate_struct_deserialize(gen::Generator& gen, const cppast::cpp_entity& e,
                                  const cppast::visitor_info& info)
 {
@@ -115,4 +195,85 @@ void generate_struct_deserialize(gen::Generator& gen, const cppast::cpp_entity&
     gen.add(LineBreak());
 }
 
+void generate_columns(gen::Generator& gen, const cppast::cpp_entity& e,
+                      const cppast::visitor_info& info)
+{
+    using namespace gen;
+
+    const auto& cpp_class = static_cast<const cppast::cpp_class&>(e);
+    std::string first_field;
+
+    gen.add(ColumnsBegin(std::string(e.name())));
+
+    for (const auto& member : cpp_class) {
+        if (member.kind() == cppast::cpp_entity_kind::member_variable_t) {
+            const auto& member_var = static_cast<const cppast::cpp_member_variable&>(member);
+            gen.add(ColumnsField(member_var.name()));
+            if (first_field.empty())
+                first_field = member_var.name();
+        }
+    }
+
+    gen.add(ColumnsSize(first_field));
+    gen.add(ColumnsEnd(std::string(e.name())));
+    gen.add(LineBreak());
+}
+
+void generate_columns_serialize(gen::Generator& gen, const cppast::cpp_entity& e,
+                                const cppast::visitor_info& info)
+{
+    using namespace gen;
+
+    const auto& cpp_class = static_cast<const cppast::cpp_class&>(e);
+
+    gen.add(StructSerializeBegin(std::string(e.name()) + "Columns"));
+    gen.add(StaticMethodSerializeBegin());
+    gen.add(ApiSerializeColumnsBegin());
+
+    for (const auto& member : cpp_class) {
+        if (member.kind() == cppast::cpp_entity_kind::member_variable_t) {
+            const auto& member_var = static_cast<const cppast::cpp_member_variable&>(member);
+            gen.add(ApiSerializeColumnField(member_var.name(), member_var.name()));
+        }
+    }
+
+    gen.add(ApiSerializeColumnsEnd());
+    gen.add(StaticMethodSerializeEnd());
+    gen.add(StructSerializeEnd());
+    gen.add(LineBreak());
+}
+
+void generate_columns_deserialize(gen::Generator& gen, const cppast::cpp_entity& e,
+                                  const cppast::visitor_info& info)
+{
+    using namespace gen;
+
+    const auto& cpp_class = static_cast<const cppast::cpp_class&>(e);
+
+    gen.add(StructDeserializeBegin(std::string(e.name()) + "Columns"));
+    gen.add(StaticMethodDeserializeBegin());
+    gen.add(ApiDeserializeColumnsBegin());
+
+    for (const auto& member : cpp_class) {
+        if (member.kind() == cppast::cpp_entity_kind::member_variable_t) {
+            const auto& member_var = static_cast<const cppast::cpp_member_variable&>(member);
+            gen.add(ApiDeserializeColumnResize(member_var.name()));
+        }
+    }
+
+    gen.add(ApiDeserializeColumnsLoopBegin());
+
+    for (const auto& member : cpp_class) {
+        if (member.kind() == cppast::cpp_entity_kind::member_variable_t) {
+            const auto& member_var = static_cast<const cppast::cpp_member_variable&>(member);
+            gen.add(ApiDeserializeColumnField(member_var.name(), member_var.name()));
+        }
+    }
+
+    gen.add(ApiDeserializeColumnsEnd());
+    gen.add(StaticMethodDeserializeEnd());
+    gen.add(StructDeserializeEnd());
+    gen.add(LineBreak());
+}
+
 }  // namespace serde_gen
@@ -5,26 +5,58 @@
 #include <cppast/cpp_entity.hpp>
 
 #include "gen.h"
+#include "profile.h"
 
 namespace serde_gen {
 
+/// Optional code generated in addition to the Serialize/Deserialize specializations
+struct GenerateOptions {
+    /// Serialize<T>::serialize_static<S> for statically dispatching to a concrete serializer
+    bool static_dispatch = false;
+    /// Serialize<T>::serialized_size<Model> for computing the encoded size in a size model
+    bool serialized_size = false;
+    /// struct-of-arrays companion <T>Columns, serialized as a sequence of T
+    bool columns = false;
+};
+
 /// Generate serde for an entire parsed file
-void generate_serde_for_file(std::ostream& outfile, const cppast::cpp_file& file);
+void generate_serde_for_file(std::ostream& outfile, const cppast::cpp_file& file,
+                             const GenerateOptions& options = {}, Profiler* profiler = nullptr);
 
 /// Generate serde for a cpp_entity
 void generate_serde_for_entity(gen::Generator& gen, const cppast::cpp_entity& e,
-                               const cppast::visitor_info& info);
+                               const cppast::visitor_info& info, const GenerateOptions& options);
 
 /// Generate serde for a class/struct with serde attribute
 void generate_serde_for_class(gen::Generator& gen, const cppast::cpp_entity& e,
-                              const cppast::visitor_info& info);
+                              const cppast::visitor_info& info, const GenerateOptions& options);
 
 /// Generate struct Serialize for a given type
 void generate_struct_serialize(gen::Generator& gen, const cppast::cpp_entity& e,
-                               const cppast::visitor_info& info);
+                               const cppast::visitor_info& info, const GenerateOptions& options);
+
+/// Generate static method serialize_static within struct Serialize for a given type
+void generate_method_serialize_static(gen::Generator& gen, const cppast::cpp_entity& e,
+                                      const cppast::visitor_info& info);
+
+/// Generate static method serialized_size within struct Serialize for a given type
+void generate_method_serialized_size(gen::Generator& gen, const cppast::cpp_entity& e,
+                                     const cppast::visitor_info& info);
 
 /// Generate struct Deserialize for a given type
 void generate_struct_deserialize(gen::Generator& gen, const cppast::cpp_entity& e,
                                  const cppast::visitor_info& info);
 
+/// Generate struct-of-arrays companion type <T>Columns for a given type
+void generate_columns(gen::Generator& gen, const cppast::cpp_entity& e,
+                      const cppast::visitor_info& info);
+
+/// Generate struct Serialize for the <T>Columns of a given type
+void generate_columns_serialize(gen::Generator& gen, const cppast::cpp_entity& e,
+                                const cppast::visitor_info& info);
+
+/// Generate struct Deserialize for the <T>Columns of a given type
+void generate_columns_deserialize(gen::Generator& gen, const cppast::cpp_entity& e,
+                                  const cppast::visitor_info& info);
+
 }  // namespace serde_gen
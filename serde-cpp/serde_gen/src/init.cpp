@@ -9,6 +9,7 @@
 
 #include "common.h"
 #include "generate.h"
+#include "profile.h"
 
 namespace serde_gen::init {
 
@@ -22,6 +23,13 @@ auto create_option_list() -> cxxopts::Options
             ("V,version", "display version information and exit")
             ("v,verbose", "be verbose when parsing")
             ("F,fatal_errors", "abort program when a parser error occurs, instead of doing error correction");
+    option_list.add_options("server")
+            ("serve", "run a persistent generation server listening on the given unix socket",
+             cxxopts::value<std::string>())
+            ("connect",
+             "forward generation to a server listening on the given unix socket, "
+             "generates locally if the server is unreachable",
+             cxxopts::value<std::string>());
     option_list.add_options("compilation")
             ("s,source", "the file that is being parsed", cxxopts::value<std::string>())
             ("o,output", "the output file that will be generated", cxxopts::value<std::string>())
@@ -33,6 +41,17 @@ auto create_option_list() -> cxxopts::Options
              cxxopts::value<std::string>())
             ("I,include_directory", "add directory to include search path",
              cxxopts::value<std::vector<std::string>>());
+    option_list.add_options("generation")
+            ("static_dispatch",
+             "also generate serialize_static<S>() for statically dispatching to a concrete serializer")
+            ("serialized_size",
+             "also generate serialized_size<Model>() for computing the encoded size in a size model")
+            ("columns",
+             "also generate a struct-of-arrays companion <T>Columns, serialized as a sequence of T");
+    option_list.add_options("profiling")
+            ("time-report", "print the time spent in each generation stage and entity counts to stderr")
+            ("trace", "write the generation stages as Chrome trace-event JSON to the given file",
+             cxxopts::value<std::string>());
     // clang-format on
     return option_list;
 }
@@ -54,6 +73,8 @@ bool handle_help_version(const cxxopts::Options& option_list, const cxxopts::Par
 auto validate_options(const cxxopts::ParseResult& options) -> int
 {
     int ret = 0;
+    if (options.count("serve"))
+        return ret;
     if (!options.count("source") || options["source"].as<std::string>().empty()) {
         std::cerr << "missing --source argument\n";
         ret = 1;
@@ -95,6 +116,20 @@ static auto add_include_directories(const cxxopts::ParseResult& options,
     }
 }
 
+static auto create_clang_compilation_config(const cxxopts::ParseResult& options,
+                                            ParseCache& cache)
+{
+    cppast::libclang_compile_config config;
+    if (options.count("database_dir")) {
+        std::string db_file = "compile_commands.json";
+        if (options.count("database_file")) {
+            db_file = options["database_file"].as<std::string>();
+        }
+        config = cache.database_config(options["database_dir"].as<std::string>(), db_file);
+    }
+    return config;
+}
+
 static auto init_clang_compilation_config(const cxxopts::ParseResult& options)
 {
     auto clang_cfg = create_clang_compilation_config(options);
@@ -103,6 +138,14 @@ static auto init_clang_compilation_config(const cxxopts::ParseResult& options)
     return clang_cfg;
 }
 
+static auto init_clang_compilation_config(const cxxopts::ParseResult& options, ParseCache& cache)
+{
+    auto clang_cfg = create_clang_compilation_config(options, cache);
+    add_compilation_flags(options, clang_cfg);
+    add_include_directories(options, clang_cfg);
+    return clang_cfg;
+}
+
 static auto init_diagnostic_logger(const cxxopts::ParseResult& options)
 {
     cppast::stderr_diagnostic_logger logger;
@@ -125,35 +168,92 @@ static auto touch_file(const std::string& filename)
     return true;
 }
 
-static auto parse_source_to_ast(const cxxopts::ParseResult& options)
+static auto parse_source_to_ast(const cxxopts::ParseResult& options, Profiler* profiler)
     -> std::unique_ptr<cppast::cpp_file>
 {
     const auto& source_filename = options["source"].as<std::string>();
     const auto fatal_errors = options.count("fatal_errors");
-    auto clang_cfg = init_clang_compilation_config(options);
+    auto clang_cfg = [&] {
+        auto stage = profile_stage(profiler, "database");
+        return init_clang_compilation_config(options);
+    }();
+    auto stage = profile_stage(profiler, "parse");
     auto logger = init_diagnostic_logger(options);
     auto src_ast = serde_gen::parse_file(clang_cfg, logger, source_filename, fatal_errors);
     return src_ast;
 }
 
-auto run_serde_generator(const cxxopts::ParseResult& options) -> int
+static auto parse_source_to_ast(const cxxopts::ParseResult& options, ParseCache& cache,
+                                Profiler* profiler) -> std::unique_ptr<cppast::cpp_file>
+{
+    const auto& source_filename = options["source"].as<std::string>();
+    const auto fatal_errors = options.count("fatal_errors");
+    auto clang_cfg = [&] {
+        auto stage = profile_stage(profiler, "database");
+        return init_clang_compilation_config(options, cache);
+    }();
+    auto stage = profile_stage(profiler, "parse");
+    cache.logger().set_verbose(options.count("verbose"));
+    auto src_ast = serde_gen::parse_file(cache, clang_cfg, source_filename, fatal_errors);
+    return src_ast;
+}
+
+template<typename ParseSource>
+static auto generate(const cxxopts::ParseResult& options, ParseSource&& parse_source) -> int
 {
     // Pre-create output file for handling #include of generated serde file while parsing source
     const auto& output_filename = options["output"].as<std::string>();
     if (!touch_file(output_filename))
         return 3;
 
-    auto src_ast = parse_source_to_ast(options);
+    Profiler profiler;
+    profiler.set_file(options["source"].as<std::string>());
+    const bool profiling = options.count("time-report") || options.count("trace");
+
+    auto src_ast = parse_source(profiling ? &profiler : nullptr);
     if (!src_ast)
         return 2;
 
     if (options.count("verbose"))
         print_ast(std::cout, *src_ast);
 
+    GenerateOptions gen_options;
+    gen_options.static_dispatch = options.count("static_dispatch");
+    gen_options.serialized_size = options.count("serialized_size");
+    gen_options.columns = options.count("columns");
+
     std::ofstream outfile(output_filename);
-    generate_serde_for_file(outfile, *src_ast);
+    generate_serde_for_file(outfile, *src_ast, gen_options, profiling ? &profiler : nullptr);
+
+    if (options.count("time-report"))
+        profiler.report(std::cerr);
+    if (options.count("trace")) {
+        const auto& trace_filename = options["trace"].as<std::string>();
+        if (!profiler.write_trace(trace_filename)) {
+            std::cerr << "Failed to write trace file: " << trace_filename << std::endl;
+            return 3;
+        }
+    }
 
     return 0;
 }
 
+auto run_serde_generator(const cxxopts::ParseResult& options) -> int
+{
+    return generate(options,
+                    [&](Profiler* profiler) { return parse_source_to_ast(options, profiler); });
+}
+
+auto run_serde_generator(const cxxopts::ParseResult& options, ParseCache& cache) -> int
+{
+    return generate(options, [&](Profiler* profiler) {
+        return parse_source_to_ast(options, cache, profiler);
+    });
+}
+
+void load_database(const cxxopts::ParseResult& options, ParseCache& cache)
+{
+    create_clang_compilation_config(options, cache);
+}
+
 }  // namespace serde_gen::init
@@ -2,6 +2,8 @@
 
 #include <cxxopts.hpp>
 
+#include "common.h"
+
 namespace serde_gen::init {
 
 /// Initialization functions called from MAIN function.
@@ -11,5 +13,8 @@ auto create_option_list() -> cxxopts::Options;
 bool handle_help_version(const cxxopts::Options &option_list, const cxxopts::ParseResult &options);
 auto validate_options(const cxxopts::ParseResult &options) -> int;
 auto run_serde_generator(const cxxopts::ParseResult &options) -> int;
+auto run_serde_generator(const cxxopts::ParseResult &options, ParseCache &cache) -> int;
+/// Loads the compilation database of the options into the cache, ahead of generating
+void load_database(const cxxopts::ParseResult &options, ParseCache &cache);
 
 }  // namespace serde_gen::init
\ No newline at end of file
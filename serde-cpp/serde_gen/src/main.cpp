@@ -1,7 +1,9 @@
 #include <iostream>
 #include "init.h"
+#include "server.h"
 
 using namespace serde_gen::init;
+using namespace serde_gen::server;
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // Main
@@ -21,6 +23,15 @@ try {
     if (ret)
         return ret;
 
+    if (options.count("serve"))
+        return run_server(options["serve"].as<std::string>());
+
+    if (options.count("connect")) {
+        ret = run_client(options["connect"].as<std::string>(), argc, argv);
+        if (ret >= 0)
+            return ret;
+    }
+
     ret = run_serde_generator(options);
     if (ret)
         return ret;
@@ -0,0 +1,127 @@
+#include "profile.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+#include <unistd.h>
+
+namespace serde_gen {
+
+Profiler::Scope::Scope(Profiler* profiler, const char* name) : profiler_(profiler), name_(name)
+{
+    if (profiler_)
+        begin_ = Clock::now();
+}
+
+Profiler::Scope::~Scope()
+{
+    if (profiler_)
+        profiler_->add_stage(name_, begin_, Clock::now());
+}
+
+void Profiler::add_stage(const char* name, Clock::time_point begin, Clock::time_point end)
+{
+    stages_.push_back({name, file_, begin, end});
+}
+
+void Profiler::add_count(const char* name, size_t count)
+{
+    counts_[{file_, name}] += count;
+}
+
+static auto to_ms(Profiler::Clock::duration d) -> double
+{
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+static auto to_us(Profiler::Clock::duration d) -> long long
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+void Profiler::report(std::ostream& out) const
+{
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+
+    // stages are grouped by file, in the order files were first seen
+    std::vector<std::string> files;
+    for (const auto& stage : stages_) {
+        if (std::find(files.begin(), files.end(), stage.file) == files.end())
+            files.push_back(stage.file);
+    }
+
+    Clock::duration total{};
+    for (const auto& file : files) {
+        Clock::duration file_total{};
+        out << "serde_gen: time report for " << file << "\n";
+        for (const auto& stage : stages_) {
+            if (stage.file != file)
+                continue;
+            out << "  " << std::left << std::setw(12) << stage.name << std::right << std::setw(12)
+                << to_ms(stage.end - stage.begin) << " ms\n";
+            file_total += stage.end - stage.begin;
+        }
+        out << "  " << std::left << std::setw(12) << "total" << std::right << std::setw(12)
+            << to_ms(file_total) << " ms\n";
+        for (const auto& [key, count] : counts_) {
+            if (key.first == file)
+                out << "  " << std::left << std::setw(12) << key.second << std::right
+                    << std::setw(12) << count << "\n";
+        }
+        total += file_total;
+    }
+    if (files.size() > 1)
+        out << "serde_gen: total " << to_ms(total) << " ms\n";
+
+    out.flags(flags);
+    out.precision(precision);
+    out << std::flush;
+}
+
+static void write_json_string(std::ostream& out, const std::string& str)
+{
+    out << '"';
+    for (char c : str) {
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                    out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c)
+                        << std::dec << std::setfill(' ');
+                else
+                    out << c;
+        }
+    }
+    out << '"';
+}
+
+auto Profiler::write_trace(const std::string& filename) const -> bool
+{
+    std::ofstream out(filename);
+    if (!out.is_open())
+        return false;
+
+    const auto pid = ::getpid();
+    out << "{\"traceEvents\":[";
+    for (size_t i = 0; i < stages_.size(); i++) {
+        const auto& stage = stages_[i];
+        out << (i ? ",\n" : "\n");
+        out << "{\"name\":";
+        write_json_string(out, stage.name);
+        out << ",\"cat\":\"serde_gen\",\"ph\":\"X\",\"ts\":" << to_us(stage.begin - origin_)
+            << ",\"dur\":" << to_us(stage.end - stage.begin) << ",\"pid\":" << pid
+            << ",\"tid\":0,\"args\":{\"file\":";
+        write_json_string(out, stage.file);
+        out << "}}";
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return static_cast<bool>(out);
+}
+
+}  // namespace serde_gen
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace serde_gen {
+
+// records the time spent in each stage of a generation run (database, parse, visit, write)
+// together with entity counts, reported as text or as Chrome trace events (chrome://tracing)
+class Profiler {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    // times a stage of the current file from construction to destruction
+    class Scope {
+       public:
+        Scope(Profiler* profiler, const char* name);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+       private:
+        Profiler* profiler_;
+        const char* name_;
+        Clock::time_point begin_;
+    };
+
+    Profiler() : origin_(Clock::now()) {}
+
+    // following stages and counts belong to file
+    void set_file(std::string file) { file_ = std::move(file); }
+
+    void add_stage(const char* name, Clock::time_point begin, Clock::time_point end);
+    void add_count(const char* name, size_t count);
+
+    // prints per-file stage timings and entity counts
+    void report(std::ostream& out) const;
+
+    // writes all stages as Chrome trace-event JSON
+    auto write_trace(const std::string& filename) const -> bool;
+
+   private:
+    struct Stage {
+        const char* name;
+        std::string file;
+        Clock::time_point begin;
+        Clock::time_point end;
+    };
+
+    Clock::time_point origin_;
+    std::string file_;
+    std::vector<Stage> stages_;
+    std::map<std::pair<std::string, std::string>, size_t> counts_;  // (file, name) -> count
+};
+
+// time a stage, does nothing without a profiler
+inline auto profile_stage(Profiler* profiler, const char* name) -> Profiler::Scope
+{
+    return Profiler::Scope(profiler, name);
+}
+
+}  // namespace serde_gen
@@ -0,0 +1,312 @@
+#include "server.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "init.h"
+
+namespace serde_gen::server {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Protocol
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// request:  u32 count, then count x (u32 length, bytes); first string is the working directory,
+//           followed by the command-line arguments (without program name).
+// response: the same string list holding the standard output and error of the generation,
+//           then i32 exit code.
+
+// Bounds of a request, larger ones are rejected before allocating for them
+constexpr uint32_t kMaxRequestStrings = 4096;
+constexpr size_t kMaxRequestBytes = 16 << 20;
+// Time a client has to send its request
+constexpr int kRequestTimeoutSeconds = 10;
+
+static bool write_all(int fd, const void* data, size_t len)
+{
+    auto ptr = static_cast<const char*>(data);
+    while (len) {
+        auto ret = ::send(fd, ptr, len, MSG_NOSIGNAL);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            return false;
+        ptr += ret;
+        len -= ret;
+    }
+    return true;
+}
+
+static bool read_all(int fd, void* data, size_t len)
+{
+    auto ptr = static_cast<char*>(data);
+    while (len) {
+        auto ret = ::recv(fd, ptr, len, 0);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            return false;
+        ptr += ret;
+        len -= ret;
+    }
+    return true;
+}
+
+static bool write_strings(int fd, const std::vector<std::string>& strings)
+{
+    uint32_t count = strings.size();
+    if (!write_all(fd, &count, sizeof(count)))
+        return false;
+    for (const auto& str : strings) {
+        uint32_t len = str.size();
+        if (!write_all(fd, &len, sizeof(len)) || !write_all(fd, str.data(), len))
+            return false;
+    }
+    return true;
+}
+
+static bool read_strings(int fd, std::vector<std::string>& strings,
+                         uint32_t max_count = UINT32_MAX, size_t max_bytes = SIZE_MAX)
+{
+    uint32_t count = 0;
+    if (!read_all(fd, &count, sizeof(count)) || count > max_count)
+        return false;
+    strings.resize(count);
+    size_t total = 0;
+    for (auto& str : strings) {
+        uint32_t len = 0;
+        if (!read_all(fd, &len, sizeof(len)))
+            return false;
+        total += len;
+        if (total > max_bytes)
+            return false;
+        str.resize(len);
+        if (!read_all(fd, str.data(), len))
+            return false;
+    }
+    return true;
+}
+
+static auto socket_address(const std::string& socket_path, sockaddr_un& addr) -> bool
+{
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "socket path too long: " << socket_path << std::endl;
+        return false;
+    }
+    std::strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Server
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Runs f with the options of a request, in the client's working directory
+template<typename Func>
+static auto with_request_options(std::vector<std::string>& request, Func&& f) -> int32_t
+{
+    if (request.empty())
+        return 1;
+
+    std::error_code ec;
+    std::filesystem::current_path(request.front(), ec);
+    if (ec) {
+        std::cerr << "Failed to change directory to " << request.front() << ": " << ec.message()
+                  << std::endl;
+        return 1;
+    }
+
+    // rebuild argv as if the client invoked serde_gen directly
+    std::vector<char*> args;
+    args.push_back(const_cast<char*>("serde_gen"));
+    for (auto it = request.begin() + 1; it != request.end(); it++)
+        args.push_back(it->data());
+    int argc = args.size();
+    char** argv = args.data();
+
+    auto option_list = init::create_option_list();
+    const auto options = option_list.parse(argc, argv);
+    return f(options);
+}
+
+static auto handle_request(ParseCache& cache, std::vector<std::string>& request) -> int32_t
+try {
+    return with_request_options(request, [&](const cxxopts::ParseResult& options) {
+        int ret = init::validate_options(options);
+        if (ret)
+            return ret;
+        return init::run_serde_generator(options, cache);
+    });
+}
+catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+}
+
+// Loads the compilation database of a request into the server's cache, so it stays loaded
+// for later requests, errors are left for the generation to report to the client
+static void prepare_request(ParseCache& cache, std::vector<std::string> request)
+try {
+    with_request_options(request, [&](const cxxopts::ParseResult& options) {
+        init::load_database(options, cache);
+        return 0;
+    });
+}
+catch (const std::exception&) {
+}
+
+static auto read_file(std::FILE* file) -> std::string
+{
+    std::string text;
+    if (!file)
+        return text;
+    std::rewind(file);
+    char buf[4096];
+    size_t len;
+    while ((len = std::fread(buf, 1, sizeof(buf), file)) > 0)
+        text.append(buf, len);
+    return text;
+}
+
+// Runs a request in a process of its own, with its standard output and error captured
+// and sent back along with the exit code, to show up in the client's build log
+[[noreturn]] static void serve_client(ParseCache& cache, int client, std::vector<std::string>& request)
+{
+    std::FILE* out = std::tmpfile();
+    std::FILE* err = std::tmpfile();
+    if (out)
+        ::dup2(::fileno(out), STDOUT_FILENO);
+    if (err)
+        ::dup2(::fileno(err), STDERR_FILENO);
+
+    int32_t ret = handle_request(cache, request);
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(stdout);
+    std::fflush(stderr);
+
+    const std::vector<std::string> output = {read_file(out), read_file(err)};
+    if (write_strings(client, output))
+        write_all(client, &ret, sizeof(ret));
+    ::_exit(0);
+}
+
+auto run_server(const std::string& socket_path) -> int
+{
+    sockaddr_un addr;
+    if (!socket_address(socket_path, addr))
+        return 1;
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        std::cerr << "Failed to create socket: " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+
+    // a previous server may have left its socket file behind
+    ::unlink(socket_path.c_str());
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, 64) < 0) {
+        std::cerr << "Failed to listen on " << socket_path << ": " << std::strerror(errno)
+                  << std::endl;
+        ::close(fd);
+        return 1;
+    }
+
+    std::cerr << "serde_gen: serving on " << socket_path << std::endl;
+
+    // requests run in forked processes, reaped by the system
+    std::signal(SIGCHLD, SIG_IGN);
+
+    ParseCache cache;
+    std::vector<std::string> request;
+    while (true) {
+        int client = ::accept(fd, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            std::cerr << "Failed to accept connection: " << std::strerror(errno) << std::endl;
+            break;
+        }
+
+        // a client stalling on its request is dropped after the timeout, not waited for
+        timeval timeout{kRequestTimeoutSeconds, 0};
+        ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        try {
+            if (read_strings(client, request, kMaxRequestStrings, kMaxRequestBytes)) {
+                // databases are loaded here to be kept, the generation runs in a child
+                // so requests run in parallel and a failing one cannot take the server down
+                prepare_request(cache, request);
+                std::cout.flush();
+                std::cerr.flush();
+                const pid_t pid = ::fork();
+                if (pid == 0) {
+                    ::close(fd);
+                    serve_client(cache, client, request);
+                }
+                if (pid < 0)
+                    std::cerr << "Failed to fork: " << std::strerror(errno) << std::endl;
+            }
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Failed to handle request: " << e.what() << std::endl;
+        }
+        ::close(client);
+    }
+
+    ::close(fd);
+    ::unlink(socket_path.c_str());
+    return 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Client
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+auto run_client(const std::string& socket_path, int argc, char* argv[]) -> int
+{
+    sockaddr_un addr;
+    if (!socket_address(socket_path, addr))
+        return -1;
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        ::close(fd);
+        return -1;
+    }
+
+    std::error_code ec;
+    std::vector<std::string> request;
+    request.push_back(std::filesystem::current_path(ec).string());
+    for (int i = 1; i < argc; i++)
+        request.emplace_back(argv[i]);
+
+    int32_t ret = -1;
+    std::vector<std::string> output;
+    if (!write_strings(fd, request) || !read_strings(fd, output) || output.size() != 2
+        || !read_all(fd, &ret, sizeof(ret)))
+        ret = -1;  // server went away, generate locally
+    else {
+        std::cout << output[0] << std::flush;
+        std::cerr << output[1] << std::flush;
+    }
+
+    ::close(fd);
+    return ret;
+}
+
+}  // namespace serde_gen::server
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+
+namespace serde_gen::server {
+
+/// Generation server, keeps the parser and compilation databases loaded between requests.
+/// A request carries the client's working directory and command-line arguments, the server
+/// runs the generation as if serde_gen was invoked with them and replies with its output
+/// and exit code. Each request runs in a process forked from the server, so requests run
+/// in parallel and the loaded state is shared; compilation databases are loaded by the
+/// server itself to be kept for later requests.
+
+/// Serve generation requests on a unix socket, never returns unless the socket fails.
+auto run_server(const std::string& socket_path) -> int;
+
+/// Forward a generation request to a server, returns its exit code,
+/// or -1 if the server could not be reached and the generation must run locally.
+auto run_client(const std::string& socket_path, int argc, char* argv[]) -> int;
+
+}  // namespace serde_gen::server
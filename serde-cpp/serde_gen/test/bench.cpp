@@ -0,0 +1,102 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+
+#include <serde/serde.h>
+#include "mytypes.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Benchmark of virtual vs static dispatch of generated serializers
+///////////////////////////////////////////////////////////////////////////////
+
+// Concrete serializer that folds every call and value into a checksum in order,
+// cheap enough for the dispatch overhead to dominate.
+class ChecksumSerializer final : public serde::Serializer {
+public:
+  uint64_t sum = 0;
+
+  void serialize_bool(bool v) final { add(v); }
+  void serialize_i8(int8_t v) final { add(v); }
+  void serialize_u8(uint8_t v) final { add(v); }
+  void serialize_i16(int16_t v) final { add(v); }
+  void serialize_u16(uint16_t v) final { add(v); }
+  void serialize_i32(int32_t v) final { add(v); }
+  void serialize_u32(uint32_t v) final { add(v); }
+  void serialize_i64(int64_t v) final { add(v); }
+  void serialize_u64(uint64_t v) final { add(v); }
+  void serialize_float(float v) final { add(v); }
+  void serialize_double(double v) final { add(v); }
+  void serialize_char(char v) final { add(v); }
+  void serialize_uchar(unsigned char v) final { add(v); }
+  void serialize_cstr(const char* v) final { for (; *v; v++) add(*v); add(7); }
+  void serialize_bytes(const void*, size_t len) final { add(len); }
+  void serialize_none() final { add(0); }
+  void serialize_seq_begin() final { add(1); }
+  void serialize_seq_end() final { add(2); }
+  void serialize_map_begin() final { add(3); }
+  void serialize_map_end() final { add(4); }
+  void serialize_map_key_begin() final { add(8); }
+  void serialize_map_key_end() final { add(9); }
+  void serialize_map_value_begin() final { add(10); }
+  void serialize_map_value_end() final { add(11); }
+  void serialize_struct_begin() final { add(5); }
+  void serialize_struct_end() final { add(6); }
+  void serialize_struct_field_begin(const char* name) final { serialize_cstr(name); add(12); }
+  void serialize_struct_field_end() final { add(13); }
+
+private:
+  // FNV-1a style over the type and bits of each value,
+  // so the same calls in another order or with other types give another sum
+  template<typename T>
+  void add(T v) {
+    uint64_t bits = 0;
+    if constexpr (std::is_floating_point_v<T>)
+      std::memcpy(&bits, &v, sizeof(v));
+    else
+      bits = static_cast<uint64_t>(v);
+    mix(sizeof(T) * 4 + std::is_signed_v<T> * 2 + std::is_floating_point_v<T>);
+    mix(bits);
+  }
+  void mix(uint64_t v) { sum = (sum ^ v) * 0x100000001b3ull; }
+};
+
+template<typename F>
+static void bench(const char* name, size_t iterations, F&& func)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; i++)
+    func(i);
+  auto end = std::chrono::steady_clock::now();
+  auto ns = std::chrono::duration<double, std::nano>(end - start).count();
+  std::cout << name << ": " << ns / iterations << " ns/op" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+  const size_t iterations = argc > 1 ? std::stoul(argv[1]) : 10000000;
+  Station station{ 7, "north", Reading{ 3, 21.5, true }, Global{ 2 } };
+  ChecksumSerializer ser;
+
+  // both dispatches must make the same calls with the same values
+  ChecksumSerializer virtual_ser, static_ser;
+  virtual_ser.serialize(station);
+  serde::serialize_static(static_ser, station);
+  if (virtual_ser.sum != static_ser.sum) {
+    std::cerr << "static dispatch differs from virtual dispatch: "
+              << static_ser.sum << " != " << virtual_ser.sum << std::endl;
+    return 1;
+  }
+
+  bench("Station virtual", iterations, [&](size_t i) {
+    station.reading.sensor = i;
+    ser.serialize(station);
+  });
+  bench("Station static", iterations, [&](size_t i) {
+    station.reading.sensor = i;
+    serde::serialize_static(ser, station);
+  });
+
+  std::cout << "checksum: " << ser.sum << std::endl;
+  return 0;
+}
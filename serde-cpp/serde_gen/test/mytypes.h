@@ -1,8 +1,21 @@
 #pragma once
 
+#include <string>
 #include "mytypes_serde.h"
 
 struct [[serde]] Global {
   int warming;
 };
 
+struct [[serde]] Reading {
+  int sensor;
+  double value;
+  bool valid;
+};
+
+struct [[serde]] Station {
+  unsigned int id;
+  std::string name;
+  Reading reading;
+  Global global;
+};
@@ -13,12 +13,56 @@ Options
   std::string [[using serde: alias("fn"), alias("FUNC")]] func;
 };
 
+using Flag = bool;
+
+struct [[serde]]
+Switch
+{
+  int id;
+  Flag on;
+};
+
+static int check(bool ok, const char* what)
+{
+  if (!ok)
+    std::cerr << "FAILED: " << what << std::endl;
+  return ok ? 0 : 1;
+}
+
 int main()
 {
+  int failures = 0;
+
   Options opts{true, 856, "main"};
   auto str = serde_yaml::to_string(opts).value();
   std::cout << str << std::endl;
-  return 0;
+  const auto fixed_size = serde::serialized_size<serde::size::Fixed>(opts);
+  std::cout << "fixed size: " << fixed_size << std::endl;
+  serde::SizeSerializer<serde::size::Fixed> size_ser;
+  size_ser.serialize(opts);
+  failures += check(fixed_size == size_ser.size(), "generated serialized_size matches SizeSerializer");
+  failures += check(fixed_size == 1 + 4 + 8 + 4, "generated serialized_size of Options");
+
+  OptionsColumns columns;
+  columns.debug = {true, false};
+  columns.line = {856, 857};
+  columns.func = {"main", "exit"};
+  str = serde_yaml::to_string(columns).value();
+  std::cout << str << std::endl;
+  auto de_columns = serde_yaml::from_str<OptionsColumns>(std::move(str)).value();
+  std::cout << "columns: " << de_columns.size() << " rows, line[1] = " << de_columns.line[1] << std::endl;
+  failures += check(de_columns.size() == 2, "columns row count");
+  failures += check(de_columns.debug == columns.debug, "bool column round trip");
+  failures += check(de_columns.line == columns.line, "int column round trip");
+  failures += check(de_columns.func == columns.func, "string column round trip");
+
+  SwitchColumns switches;
+  switches.id = {1, 2, 3};
+  switches.on = {false, true, true};
+  auto de_switches = serde_yaml::from_str<SwitchColumns>(serde_yaml::to_string(switches).value()).value();
+  failures += check(de_switches.on == switches.on, "bool alias column round trip");
+
+  return failures ? 1 : 0;
 }
 
 //namespace foo {
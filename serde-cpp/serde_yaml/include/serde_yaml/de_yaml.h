@@ -1,9 +1,12 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <serde/de.h>
 #include <serde/error.h>
 #include <serde/result.hpp>
+#include "options.h"
+#include "instrument.h"
 #include "detail/de_detail.h"
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -15,12 +18,96 @@ namespace serde_yaml {
 template<typename T>
 auto from_str(std::string&& str) -> cpp::result<T, serde::Error>
 {
-  auto de = detail::DeserializerNew(std::move(str));
-  std::ignore = detail::DeserializerParse(de.get());
-  T obj{};
-  de->deserialize(obj);
+  using instrument::Phase, instrument::PhaseScope;
+  std::unique_ptr<serde::Deserializer> de;
+  {
+    PhaseScope phase(Phase::Parse);
+    de = detail::DeserializerNew(std::move(str));
+    auto parsed = detail::DeserializerParse(de.get());
+    if (!parsed)
+      return cpp::fail(std::move(parsed).error());
+  }
+  PhaseScope phase(Phase::Objects);
+  T obj = serde::make_default<T>(*de);
+  auto done = detail::DeserializerRun(de.get(), obj);
+  if (!done)
+    return cpp::fail(std::move(done).error());
   return std::move(obj);
 }
 
+/// YAML Deserializer function from yaml string to T, with parsing options
+template<typename T>
+auto from_str(std::string&& str, const ParseOptions& options) -> cpp::result<T, serde::Error>
+{
+  using instrument::Phase, instrument::PhaseScope;
+  std::unique_ptr<serde::Deserializer> de;
+  {
+    PhaseScope phase(Phase::Parse);
+    de = detail::DeserializerNew(std::move(str), options);
+    auto parsed = detail::DeserializerParse(de.get());
+    if (!parsed)
+      return cpp::fail(std::move(parsed).error());
+  }
+  PhaseScope phase(Phase::Objects);
+  T obj = serde::make_default<T>(*de);
+  auto done = detail::DeserializerRun(de.get(), obj);
+  if (!done)
+    return cpp::fail(std::move(done).error());
+  return std::move(obj);
+}
+
+/// YAML Deserializer function from yaml string into an existing obj, for partial updates.
+/// Struct fields missing from the input keep their value, nested structs are updated
+/// the same way. Containers and pointees present in the input are replaced: sequence
+/// elements are reset before being read over the previous ones at the same index, so a
+/// struct element keeps nothing of its old fields, and pointers get a new object.
+/// Strings and vectors keep their capacity. A syntax error leaves obj untouched, but
+/// an error while deserializing may leave it partially updated.
+template<typename T>
+auto from_str_into(T& obj, std::string&& str, const ParseOptions& options = {}) -> cpp::result<void, serde::Error>
+{
+  using instrument::Phase, instrument::PhaseScope;
+  std::unique_ptr<serde::Deserializer> de;
+  {
+    PhaseScope phase(Phase::Parse);
+    de = detail::DeserializerNew(std::move(str), options);
+    auto parsed = detail::DeserializerParse(de.get());
+    if (!parsed)
+      return cpp::fail(std::move(parsed).error());
+  }
+  PhaseScope phase(Phase::Objects);
+  return detail::DeserializerRun(de.get(), obj);
+}
+
+/// YAML Deserializer function from the node at path of a yaml string to T.
+/// path is a JSON pointer (RFC 6901) such as "/services/0/name", or "" for the root.
+template<typename T>
+auto from_str_at(std::string&& str, std::string_view path) -> cpp::result<T, serde::Error>
+{
+  using instrument::Phase, instrument::PhaseScope;
+  std::unique_ptr<serde::Deserializer> de;
+  {
+    PhaseScope phase(Phase::Parse);
+    de = detail::DeserializerNew(std::move(str));
+    auto parsed = detail::DeserializerParseAt(de.get(), path);
+    if (!parsed)
+      return cpp::fail(std::move(parsed).error());
+  }
+  PhaseScope phase(Phase::Objects);
+  T obj = serde::make_default<T>(*de);
+  auto done = detail::DeserializerRun(de.get(), obj);
+  if (!done)
+    return cpp::fail(std::move(done).error());
+  return std::move(obj);
+}
+
+/// Same as from_str_at, but only the top-level section holding path is parsed
+/// when the yaml string is a block mapping at the root, otherwise all of it.
+template<typename T>
+auto from_str_at_lazy(std::string_view str, std::string_view path) -> cpp::result<T, serde::Error>
+{
+  return from_str_at<T>(std::string(detail::PathSection(str, path)), path);
+}
+
 } // namespace serde_yaml
 
@@ -2,17 +2,37 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <serde/error.h>
 #include <serde/result.hpp>
 #include <serde/de/deserializer.h>
+#include <serde/ser/serializer.h>
+#include "../options.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 // Serde YAML detail
 ///////////////////////////////////////////////////////////////////////////////
 namespace serde_yaml::detail {
 
-auto DeserializerNew(std::string&& str) -> std::unique_ptr<serde::Deserializer>;
+auto DeserializerNew(std::string&& str, const ParseOptions& options = {}) -> std::unique_ptr<serde::Deserializer>;
 auto DeserializerParse(serde::Deserializer* de) -> cpp::result<void, serde::Error>;
+/// Tree capacity reserved by the last parse of de, from its hint or estimated from the input
+auto DeserializerCapacity(serde::Deserializer* de) -> Capacity;
+/// Nodes and arena bytes the last parse of de used
+auto DeserializerSize(serde::Deserializer* de) -> Capacity;
+auto DeserializerParseAt(serde::Deserializer* de, std::string_view path) -> cpp::result<void, serde::Error>;
+auto PathSection(std::string_view yaml, std::string_view path) -> std::string_view;
+auto DeserializerReset(serde::Deserializer* de, std::string&& str) -> cpp::result<void, serde::Error>;
+auto DeserializerTranscode(serde::Deserializer* de, serde::Serializer& ser) -> cpp::result<void, serde::Error>;
+auto DeserializerRun(serde::Deserializer* de, void (*run)(serde::Deserializer&, void*), void* obj)
+    -> cpp::result<void, serde::Error>;
+
+/// Deserialize obj from de, failing with the error rapidyaml raises on a tree it cannot read
+template<typename T>
+auto DeserializerRun(serde::Deserializer* de, T& obj) -> cpp::result<void, serde::Error>
+{
+  return DeserializerRun(de, [](serde::Deserializer& de, void* obj) { de.deserialize(*static_cast<T*>(obj)); }, &obj);
+}
 
 } // namespace serde_yaml::detail
 
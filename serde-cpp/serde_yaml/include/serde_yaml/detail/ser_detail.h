@@ -5,14 +5,23 @@
 #include <serde/error.h>
 #include <serde/result.hpp>
 #include <serde/ser/serializer.h>
+#include "../options.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 // Serde YAML detail
 ///////////////////////////////////////////////////////////////////////////////
 namespace serde_yaml::detail {
 
-auto SerializerNew() -> std::unique_ptr<serde::Serializer>;
-auto SerializerOutput(serde::Serializer* ser) -> cpp::result<std::string, serde::Error>;
+auto SerializerNew(const Capacity& capacity = {}, std::pmr::memory_resource* tree_resource = nullptr)
+    -> std::unique_ptr<serde::Serializer>;
+auto SerializerCapacity(serde::Serializer* ser) -> Capacity;
+auto SerializerOutput(serde::Serializer* ser, const EmitOptions& options = {})
+    -> cpp::result<std::string, serde::Error>;
+
+
+/// Tree capacity used by the last serialization of T on this thread, the hint for the next one
+template<typename T>
+inline thread_local Capacity last_capacity{};
 
 } // namespace serde_yaml::detail
 
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+
+///////////////////////////////////////////////////////////////////////////////
+// Serde YAML allocation instrumentation
+///////////////////////////////////////////////////////////////////////////////
+// Counts the heap allocations of to_string/from_str calls per phase.
+// Allocations of the YAML tree and parser are always seen, other allocations
+// (objects, output text, trees given a memory resource) only when the program
+// links the global operator new hook target `serde_yaml_alloc_hook`.
+// Counting is per thread, the worker threads of from_str_multi are not counted.
+namespace serde_yaml::instrument {
+
+/// Number and bytes of allocations
+struct Allocations {
+  size_t count = 0;
+  size_t bytes = 0;
+};
+
+/// Allocations of serde_yaml calls, per phase
+struct Stats {
+  Allocations parse;   ///< from_str: input copy, YAML tree and parser
+  Allocations objects; ///< from_str: the deserialized objects
+  Allocations tree;    ///< to_string: YAML tree built by the serializer
+  Allocations emit;    ///< to_string: output text
+
+  Allocations total() const {
+    return {parse.count + objects.count + tree.count + emit.count,
+            parse.bytes + objects.bytes + tree.bytes + emit.bytes};
+  }
+};
+
+enum class Phase { None, Parse, Objects, Tree, Emit };
+
+namespace detail {
+inline thread_local Stats* active = nullptr;
+inline thread_local Phase phase = Phase::None;
+} // namespace detail
+
+/// Records an allocation of bytes in the current phase of the calling thread, if counting
+inline void count(size_t bytes) noexcept {
+  auto stats = detail::active;
+  if (!stats)
+    return;
+  Allocations* allocs = nullptr;
+  switch (detail::phase) {
+    case Phase::None: return;
+    case Phase::Parse: allocs = &stats->parse; break;
+    case Phase::Objects: allocs = &stats->objects; break;
+    case Phase::Tree: allocs = &stats->tree; break;
+    case Phase::Emit: allocs = &stats->emit; break;
+  }
+  allocs->count++;
+  allocs->bytes += bytes;
+}
+
+/// Counts the allocations of this thread's serde_yaml calls into stats while alive
+class Counter {
+public:
+  explicit Counter(Stats& stats) : previous(detail::active) { detail::active = &stats; }
+  ~Counter() { detail::active = previous; }
+  Counter(const Counter&) = delete;
+  Counter& operator=(const Counter&) = delete;
+
+private:
+  Stats* previous;
+};
+
+/// Marks the phase of the allocations of this thread while alive, set by serde_yaml calls
+class PhaseScope {
+public:
+  explicit PhaseScope(Phase phase) : previous(detail::phase) { detail::phase = phase; }
+  ~PhaseScope() { detail::phase = previous; }
+  PhaseScope(const PhaseScope&) = delete;
+  PhaseScope& operator=(const PhaseScope&) = delete;
+
+private:
+  Phase previous;
+};
+
+/// Allocations made by func on this thread, e.g. `measure([&] { to_string(obj); })`
+template<typename Func>
+Stats measure(Func&& func) {
+  Stats stats;
+  {
+    Counter counter(stats);
+    func();
+  }
+  return stats;
+}
+
+} // namespace serde_yaml::instrument
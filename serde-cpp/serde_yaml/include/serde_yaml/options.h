@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+///////////////////////////////////////////////////////////////////////////////
+// Serde YAML options
+///////////////////////////////////////////////////////////////////////////////
+namespace serde_yaml {
+
+/// Initial capacity of the YAML tree, so it is not grown while parsing or serializing
+struct Capacity {
+  /// Number of nodes, 0 for the default
+  size_t nodes = 0;
+  /// Bytes of the arena holding strings that are not in the input, e.g. serialized numbers
+  size_t arena = 0;
+};
+
+/// Emission policy for to_string, the default emits every container in block style
+struct EmitOptions {
+  /// Emit sequences and maps that hold only scalars in flow style, e.g. `[1, 2, 3]`
+  bool flow_scalar_containers = false;
+  /// Emit any sequence or map with at most this many descendant nodes in flow style, 0 to disable
+  size_t flow_max_nodes = 0;
+  /// Initial tree capacity, by default the capacity used by the last to_string of the same type
+  Capacity capacity;
+  /// Memory of the tree's nodes and arena, must outlive the call; null for the global allocator
+  std::pmr::memory_resource* tree_resource = nullptr;
+};
+
+/// Parsing options for from_str
+struct ParseOptions {
+  /// Initial tree capacity, by default estimated from the lines and indicators of the input
+  Capacity capacity;
+  /// Memory of the tree's nodes and arena, must outlive the call; null for the global allocator
+  std::pmr::memory_resource* tree_resource = nullptr;
+  /// Memory of the deserialized std::pmr objects and allocator-aware structs (see
+  /// serde::make_default), must outlive them; null for their default resource
+  std::pmr::memory_resource* object_resource = nullptr;
+};
+
+} // namespace serde_yaml
@@ -1,10 +1,13 @@
 #pragma once
 
 #include <string>
+#include <type_traits>
 #include <serde/ser.h>
 #include <serde/error.h>
 #include <serde/result.hpp>
 
+#include "options.h"
+#include "instrument.h"
 #include "detail/ser_detail.h"
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -12,13 +15,29 @@
 ///////////////////////////////////////////////////////////////////////////////
 namespace serde_yaml {
 
+/// YAML Serializer function from T to yaml string, with an emission policy
+template<typename T>
+auto to_string(T&& obj, const EmitOptions& options) -> cpp::result<std::string, serde::Error>
+{
+  using instrument::Phase, instrument::PhaseScope;
+  auto& last = detail::last_capacity<std::decay_t<T>>;
+  const bool hint = options.capacity.nodes || options.capacity.arena;
+  std::unique_ptr<serde::Serializer> ser;
+  {
+    PhaseScope phase(Phase::Tree);
+    ser = detail::SerializerNew(hint ? options.capacity : last, options.tree_resource);
+    ser->serialize(std::forward<T>(obj));
+    last = detail::SerializerCapacity(ser.get());
+  }
+  PhaseScope phase(Phase::Emit);
+  return detail::SerializerOutput(ser.get(), options);
+}
+
 /// YAML Serializer function from T to yaml string
 template<typename T>
 auto to_string(T&& obj) -> cpp::result<std::string, serde::Error>
 {
-  auto ser = detail::SerializerNew();
-  ser->serialize(std::forward<T>(obj));
-  return detail::SerializerOutput(ser.get());
+  return to_string(std::forward<T>(obj), EmitOptions{});
 }
 
 } // namespace serde_yaml
@@ -3,4 +3,6 @@
 // include serialization and deserialization
 #include "ser_yaml.h"
 #include "de_yaml.h"
+#include "stream_yaml.h"
 
+#include "transcode_yaml.h"
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <serde/ser/size.h>
+#include <serde/base64.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Serde YAML size
+///////////////////////////////////////////////////////////////////////////////
+namespace serde_yaml {
+
+/// Size model estimating the length of the block-style YAML emitted by to_string,
+/// for use with serde::serialized_size and serde::SizeSerializer.
+/// Indentation and quoting are not counted, so the estimate falls short by about
+/// the indentation, getting closer the flatter the data.
+struct SizeModel {
+  static constexpr bool fixed_width = false;
+
+  template<typename T>
+  static size_t scalar(T v) {
+    if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, char>) {
+      return 1;
+    }
+    else if constexpr (std::is_floating_point_v<T>) {
+      if (!std::isfinite(v))
+        return 4 + (v < 0); // .nan .inf -.inf
+#if defined(__cpp_lib_to_chars)
+      char buf[32];
+      return static_cast<size_t>(std::to_chars(buf, buf + sizeof(buf), v).ptr - buf);
+#else
+      return std::is_same_v<T, float> ? 9 : 17;
+#endif
+    }
+    else {
+      using U = std::make_unsigned_t<T>;
+      auto u = static_cast<U>(v);
+      size_t len = 1;
+      if constexpr (std::is_signed_v<T>) {
+        if (v < 0) { u = static_cast<U>(U{0} - u); len++; }
+      }
+      for (; u >= 10; u /= 10) len++;
+      return len;
+    }
+  }
+  static constexpr size_t string(size_t len) { return len; }
+  static constexpr size_t bytes(size_t len) { return serde::base64::encoded_length(len); }
+  static constexpr size_t none() { return 4; } // null
+  static constexpr size_t some() { return 0; }
+  static constexpr size_t seq(size_t count) { return count ? 0 : 2; } // []
+  static constexpr size_t element() { return 3; } // "- " and newline
+  static constexpr size_t map(size_t count) { return count ? 0 : 2; } // {}
+  static constexpr size_t entry() { return 3; } // ": " and newline
+  static constexpr size_t structure() { return 0; }
+  static size_t field(const char* name) { return std::strlen(name) + entry(); }
+};
+
+/// Estimated length of the YAML text of obj, without serializing it (see SizeModel)
+template<typename T>
+size_t estimated_size(const T& obj)
+{
+  serde::SizeSerializer<SizeModel> ser;
+  ser.serialize(obj);
+  return ser.size();
+}
+
+} // namespace serde_yaml
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iosfwd>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <serde/de.h>
+#include <serde/error.h>
+#include <serde/result.hpp>
+#include "instrument.h"
+#include "detail/de_detail.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Serde YAML streaming
+///////////////////////////////////////////////////////////////////////////////
+namespace serde_yaml {
+
+/// Splits a YAML stream into its documents, reading one document at a time.
+/// Documents are separated by `---` and ended by `...` markers at the start of a line,
+/// documents with nothing but blank lines, comments and directives are skipped.
+class DocumentSplitter {
+public:
+  explicit DocumentSplitter(std::istream& input) : input(input) {}
+
+  /// Reads the next document into document, false at the end of the stream
+  bool next(std::string& document);
+
+private:
+  std::istream& input;
+  std::string line;
+  std::string pending; // start of the next document, after a `---` marker
+};
+
+/// Range of the documents of a YAML stream deserialized into T, one at a time,
+/// so memory is bounded by the largest document instead of the whole stream.
+/// A single parse tree is reused for all documents.
+template<typename T>
+class DocumentStream {
+public:
+  using value_type = cpp::result<T, serde::Error>;
+
+  explicit DocumentStream(std::istream& input) : splitter(input) {}
+
+  /// Next document deserialized into T, std::nullopt at the end of the stream
+  auto next() -> std::optional<value_type>
+  {
+    using instrument::Phase, instrument::PhaseScope;
+    {
+      PhaseScope phase(Phase::Parse);
+      if (!splitter.next(document))
+        return std::nullopt;
+      if (!de)
+        de = detail::DeserializerNew({});
+      auto parsed = detail::DeserializerReset(de.get(), std::move(document));
+      if (!parsed)
+        return value_type(cpp::fail(std::move(parsed).error()));
+    }
+    PhaseScope phase(Phase::Objects);
+    T obj = serde::make_default<T>(*de);
+    auto done = detail::DeserializerRun(de.get(), obj);
+    if (!done)
+      return value_type(cpp::fail(std::move(done).error()));
+    return value_type(std::move(obj));
+  }
+
+  class iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = DocumentStream::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type*;
+    using reference = value_type&;
+
+    iterator() = default;
+    explicit iterator(DocumentStream* stream) : stream(stream) { ++*this; }
+
+    reference operator*() { return *current; }
+    pointer operator->() { return &*current; }
+
+    iterator& operator++()
+    {
+      current = stream->next();
+      if (!current)
+        stream = nullptr;
+      return *this;
+    }
+
+    bool operator==(const iterator& other) const { return stream == other.stream; }
+    bool operator!=(const iterator& other) const { return stream != other.stream; }
+
+  private:
+    DocumentStream* stream = nullptr;
+    std::optional<value_type> current;
+  };
+
+  iterator begin() { return iterator(this); }
+  iterator end() { return iterator(); }
+
+private:
+  DocumentSplitter splitter;
+  std::string document;
+  std::unique_ptr<serde::Deserializer> de;
+};
+
+/// YAML Deserializer of every document of a yaml stream into T
+template<typename T>
+auto from_stream(std::istream& input) -> DocumentStream<T>
+{
+  return DocumentStream<T>(input);
+}
+
+/// Splits a YAML stream held in memory into its documents in a single scan,
+/// following the same rules as DocumentSplitter. The views point into input.
+auto split_documents(std::string_view input) -> std::vector<std::string_view>;
+
+/// YAML Deserializer of every document of a yaml stream into T, in input order.
+/// Documents are parsed and deserialized in parallel on up to `threads` threads
+/// (0 for one per hardware thread), each thread reusing a single parse tree.
+/// Fails with the error of the first document, in input order, that could not be parsed;
+/// an exception thrown while deserializing a document becomes the error of that document.
+template<typename T>
+auto from_str_multi(std::string_view input, unsigned threads = 0)
+    -> cpp::result<std::vector<T>, serde::Error>
+{
+  const auto documents = split_documents(input);
+  std::vector<std::optional<T>> values(documents.size());
+  std::vector<cpp::result<void, serde::Error>> parsed(documents.size());
+
+  std::atomic<size_t> next{0};
+  auto worker = [&] {
+    using instrument::Phase, instrument::PhaseScope;
+    std::unique_ptr<serde::Deserializer> de;
+    for (size_t i = next++; i < documents.size(); i = next++) {
+      try {
+        {
+          PhaseScope phase(Phase::Parse);
+          std::string document(documents[i]);
+          if (!de) {
+            de = detail::DeserializerNew(std::move(document));
+            parsed[i] = detail::DeserializerParse(de.get());
+          }
+          else {
+            parsed[i] = detail::DeserializerReset(de.get(), std::move(document));
+          }
+          if (!parsed[i])
+            continue;
+        }
+        PhaseScope phase(Phase::Objects);
+        T obj = serde::make_default<T>(*de);
+        parsed[i] = detail::DeserializerRun(de.get(), obj);
+        if (parsed[i])
+          values[i].emplace(std::move(obj));
+      }
+      catch (const std::exception& e) {
+        parsed[i] = cpp::fail(serde::Error{serde::Error::Kind::Invalid, 0, 0, e.what()});
+      }
+      catch (...) {
+        parsed[i] = cpp::fail(serde::Error{serde::Error::Kind::Invalid, 0, 0, "unknown exception"});
+      }
+    }
+  };
+
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  threads = static_cast<unsigned>(std::min<size_t>(threads, documents.size()));
+
+  // joins the started threads also when starting another one throws
+  struct Pool {
+    std::vector<std::thread> threads;
+    ~Pool() {
+      for (auto& thread : threads)
+        thread.join();
+    }
+  };
+  {
+    Pool pool;
+    for (unsigned t = 1; t < threads; t++)
+      pool.threads.emplace_back(worker);
+    worker();
+  }
+
+  std::vector<T> result;
+  result.reserve(documents.size());
+  for (size_t i = 0; i < documents.size(); i++) {
+    if (!parsed[i])
+      return cpp::fail(std::move(parsed[i]).error());
+    result.push_back(std::move(*values[i]));
+  }
+  return std::move(result);
+}
+
+} // namespace serde_yaml
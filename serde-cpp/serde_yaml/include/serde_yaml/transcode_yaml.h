@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <serde/ser.h>
+#include <serde/error.h>
+#include <serde/result.hpp>
+#include "options.h"
+#include "instrument.h"
+#include "detail/de_detail.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Serde YAML transcoding
+///////////////////////////////////////////////////////////////////////////////
+namespace serde_yaml {
+
+/// Feeds a yaml string into any Serializer, e.g. a TapeSerializer or another format's,
+/// walking the parsed tree once without deserializing into C++ types.
+/// Mappings and sequences map to serialize_map/serialize_seq calls, a stream of several
+/// documents to a sequence of them, aliases are resolved. Unquoted scalars are typed as
+/// null, bool, i64, u64 or double when they read as such, strings otherwise.
+inline auto transcode(std::string&& str, serde::Serializer& ser, const ParseOptions& options = {})
+    -> cpp::result<void, serde::Error>
+{
+  using instrument::Phase, instrument::PhaseScope;
+  std::unique_ptr<serde::Deserializer> de;
+  {
+    PhaseScope phase(Phase::Parse);
+    de = detail::DeserializerNew(std::move(str), options);
+    auto parsed = detail::DeserializerParse(de.get());
+    if (!parsed)
+      return cpp::fail(std::move(parsed).error());
+  }
+  PhaseScope phase(Phase::Emit);
+  return detail::DeserializerTranscode(de.get(), ser);
+}
+
+/// Same as transcode, for the node at path of the yaml string (a JSON pointer, see from_str_at)
+inline auto transcode_at(std::string&& str, std::string_view path, serde::Serializer& ser)
+    -> cpp::result<void, serde::Error>
+{
+  using instrument::Phase, instrument::PhaseScope;
+  std::unique_ptr<serde::Deserializer> de;
+  {
+    PhaseScope phase(Phase::Parse);
+    de = detail::DeserializerNew(std::move(str));
+    auto parsed = detail::DeserializerParseAt(de.get(), path);
+    if (!parsed)
+      return cpp::fail(std::move(parsed).error());
+  }
+  PhaseScope phase(Phase::Emit);
+  return detail::DeserializerTranscode(de.get(), ser);
+}
+
+} // namespace serde_yaml
@@ -0,0 +1,51 @@
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "serde_yaml/instrument.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Global operator new replacement counting allocations for serde_yaml::instrument.
+// Linked only into programs that ask for it (serde_yaml_alloc_hook). The array and
+// nothrow forms of operator new/delete forward to these by default, but the aligned
+// forms allocate on their own, so they are replaced as well.
+////////////////////////////////////////////////////////////////////////////////
+
+void* operator new(std::size_t size)
+{
+  serde_yaml::instrument::count(size);
+  if (void* mem = std::malloc(size ? size : 1))
+    return mem;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* mem) noexcept
+{
+  std::free(mem);
+}
+
+void operator delete(void* mem, std::size_t) noexcept
+{
+  std::free(mem);
+}
+
+void* operator new(std::size_t size, std::align_val_t align)
+{
+  serde_yaml::instrument::count(size);
+  const auto alignment = static_cast<std::size_t>(align);
+  // aligned_alloc wants a size multiple of the alignment
+  const auto rounded = (size + alignment - 1) / alignment * alignment;
+  if (void* mem = std::aligned_alloc(alignment, rounded ? rounded : alignment))
+    return mem;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* mem, std::align_val_t) noexcept
+{
+  std::free(mem);
+}
+
+void operator delete(void* mem, std::size_t, std::align_val_t) noexcept
+{
+  std::free(mem);
+}
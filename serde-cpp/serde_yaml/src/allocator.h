@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+#include <ryml.hpp>
+
+#include "serde_yaml/instrument.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Serde YAML tree allocation
+////////////////////////////////////////////////////////////////////////////////
+namespace serde_yaml::detail {
+
+/// Allocator of a tree: a memory resource if given, otherwise the callbacks it replaces.
+/// Allocations of the callbacks are counted for serde_yaml::instrument, as they do not go
+/// through operator new; those of a resource are left to the operator new hook, which sees
+/// them when they reach the heap. Must outlive the tree.
+struct TreeAllocator {
+  ryml::Callbacks inner;
+  std::pmr::memory_resource* resource = nullptr;
+};
+
+/// Callbacks cb with the tree's nodes and arena allocated through allocator
+inline auto TreeCallbacks(ryml::Callbacks cb, TreeAllocator* allocator) -> ryml::Callbacks
+{
+  allocator->inner = cb;
+  cb.m_user_data = allocator;
+  cb.m_allocate = [](size_t len, void* hint, void* user_data) -> void* {
+    auto alloc = static_cast<TreeAllocator*>(user_data);
+    if (alloc->resource)
+      return alloc->resource->allocate(len, alignof(std::max_align_t));
+    instrument::count(len);
+    return alloc->inner.m_allocate(len, hint, alloc->inner.m_user_data);
+  };
+  cb.m_free = [](void* mem, size_t len, void* user_data) {
+    auto alloc = static_cast<TreeAllocator*>(user_data);
+    if (alloc->resource)
+      alloc->resource->deallocate(mem, len, alignof(std::max_align_t));
+    else
+      alloc->inner.m_free(mem, len, alloc->inner.m_user_data);
+  };
+  return cb;
+}
+
+} // namespace serde_yaml::detail
@@ -1,32 +1,244 @@
 #include "serde_yaml/de_yaml.h"
 
 #include <stack>
+#include <map>
+#include <memory>
+#include <typeinfo>
 #include <cstring>
+#include <string_view>
+#include <charconv>
 #include <iostream>
+#include <limits>
+#include <type_traits>
 
 #include <ryml_std.hpp>
 #include <ryml.hpp>
 #include <c4/format.hpp>
 
+#include "serde/base64.h"
+#include "allocator.h"
+
 ////////////////////////////////////////////////////////////////////////////////
 // Serde YAML
 ////////////////////////////////////////////////////////////////////////////////
 namespace serde_yaml {
 
+// Reference token of a JSON pointer (RFC 6901) with ~1 and ~0 unescaped to / and ~
+static auto unescape_token(std::string_view token) -> std::string
+{
+  std::string key;
+  key.reserve(token.size());
+  for (size_t i = 0; i < token.size(); i++) {
+    if (token[i] == '~' && i + 1 < token.size() && (token[i+1] == '0' || token[i+1] == '1'))
+      key += token[++i] == '0' ? '~' : '/';
+    else
+      key += token[i];
+  }
+  return key;
+}
+
+// Event handler type of a rapidyaml 0.7+ Parser, a ParseEngine<EventHandlerTree>
+template<typename Parser>
+struct ParserHandler {};
+template<template<typename> class Engine, typename Handler>
+struct ParserHandler<Engine<Handler>> { using type = Handler; };
+
+// Parses src in place into tree with a parser made from the tree's callbacks, so that its
+// errors and allocations go through them whatever the global callbacks are.
+// Parser(callbacks) before rapidyaml 0.7, Parser(&handler) with a handler of the callbacks since.
+template<typename Parser>
+auto parse_in_place_with_callbacks(ryml::Tree& tree, ryml::substr src, int)
+    -> decltype(Parser(tree.callbacks()), void())
+{
+  Parser parser(tree.callbacks());
+  parser.parse_in_place({}, src, &tree);
+}
+template<typename Parser>
+auto parse_in_place_with_callbacks(ryml::Tree& tree, ryml::substr src, long)
+    -> decltype(typename ParserHandler<Parser>::type(tree.callbacks()), void())
+{
+  typename ParserHandler<Parser>::type handler(tree.callbacks());
+  Parser parser(&handler);
+  ryml::parse_in_place(&parser, src, &tree);
+}
+
+// Thrown by the rapidyaml error handler of a deserializer's tree,
+// caught in parse() and around anything else reading the tree (DeserializerRun)
+struct ParseError {
+  serde::Error error;
+};
+
 class YamlDeserializer final : public serde::Deserializer {
   std::string yaml;
+  Capacity capacity;
+  Capacity reserved; // by the last parse, from capacity or the input
+  std::pmr::memory_resource* object_resource;
+  detail::TreeAllocator allocator;
   ryml::Tree tree;
   std::stack<ryml::NodeRef> stack;
+  std::map<ryml::csubstr, std::pair<std::shared_ptr<void>, const std::type_info*>> shared;
   bool expect_key = false;
   bool entry_find = false;
+  // field found by deserialize_struct_field_present, taken by the field_begin that follows
+  const char* present_name = nullptr;
+  ryml::NodeRef present_field;
 
 public:
-  YamlDeserializer(std::string yaml) : yaml(std::move(yaml)) {
+  YamlDeserializer(std::string yaml, const ParseOptions& options)
+      : yaml(std::move(yaml)), capacity(options.capacity), object_resource(options.object_resource),
+        allocator{{}, options.tree_resource}, tree(callbacks(&allocator)) {
   }
 
-  void parse() {
-    ryml::parse_in_place(ryml::substr(yaml.data(), yaml.length()), &tree);
+  auto parse() -> cpp::result<void, serde::Error> {
+    try {
+      reserve();
+      parse_in_place_with_callbacks<ryml::Parser>(tree, ryml::substr(yaml.data(), yaml.length()), 0);
+    }
+    catch (ParseError& e) {
+      return cpp::fail(std::move(e.error));
+    }
     stack.push(tree.rootref());
+    return {};
+  }
+
+  // rapidyaml's default error handler aborts the process,
+  // instead unwind back to parse() or DeserializerRun with the location and message.
+  // parse() hands these to the parser as well, not only to the tree.
+  static ryml::Callbacks callbacks(detail::TreeAllocator* allocator) {
+    ryml::Callbacks cb = detail::TreeCallbacks(ryml::get_callbacks(), allocator);
+    cb.m_error = &on_error;
+    return cb;
+  }
+
+  [[noreturn]] static void on_error(const char* msg, size_t len, ryml::Location loc, void*) {
+    throw ParseError{serde::Error{serde::Error::Kind::Syntax, loc.line, loc.col, std::string(msg, len)}};
+  }
+
+  // Reserve the tree up front instead of growing it while parsing: the capacity hint or else
+  // one node per line, flow collection, flow separator, block entry "- " and key ": " of the
+  // input. Every node but the root starts at one of these, so the tree only grows for input
+  // with several nodes on one of them; text in scalars and comments over-counts.
+  void reserve() {
+    size_t nodes = capacity.nodes;
+    if (!nodes) {
+      nodes = 2;
+      for (size_t i = 0; i < yaml.size(); i++) {
+        const char c = yaml[i];
+        const char next = i + 1 < yaml.size() ? yaml[i + 1] : '\n';
+        const bool indicator = (c == '-' || c == ':') && (next == ' ' || next == '\n' || next == '\r');
+        nodes += (c == '\n') | (c == ',') | (c == '[') | (c == '{') | indicator;
+      }
+    }
+    tree.reserve(nodes);
+    if (capacity.arena)
+      tree.reserve_arena(capacity.arena);
+    reserved = {nodes, capacity.arena};
+  }
+
+  Capacity reservation() const {
+    return reserved;
+  }
+
+  Capacity size() const {
+    return {tree.size(), tree.arena_size()};
+  }
+
+  // Make the node at a JSON pointer path the root of deserialization, false if there is none
+  bool seek(std::string_view path) {
+    auto node = tree.rootref();
+    if (node.is_stream() && node.has_children())
+      node = node.first_child();
+
+    while (!path.empty()) {
+      if (path.front() != '/')
+        return false;
+      path.remove_prefix(1);
+      const auto token = path.substr(0, path.find('/'));
+      path.remove_prefix(token.size());
+
+      if (node.is_map()) {
+        const auto key = unescape_token(token);
+        node = node.find_child(ryml::csubstr(key.data(), key.size()));
+      }
+      else if (node.is_seq()) {
+        size_t index = 0;
+        auto res = std::from_chars(token.data(), token.data() + token.size(), index);
+        if (token.empty() || res.ec != std::errc() || res.ptr != token.data() + token.size()
+            || index >= node.num_children())
+          return false;
+        node = node.child(index);
+      }
+      else {
+        return false;
+      }
+      if (!node.valid() || node.is_seed())
+        return false;
+    }
+
+    stack = {};
+    stack.push(node);
+    return true;
+  }
+
+  // Replace the input, keeping the tree's node and arena capacity for the next parse
+  void reset(std::string&& str) {
+    yaml = std::move(str);
+    tree.clear();
+    tree.clear_arena();
+    stack = {};
+    shared.clear();
+    expect_key = false;
+    entry_find = false;
+    present_name = nullptr;
+  }
+
+  // A finished sequence or map that is itself an element of a sequence
+  // moves on to the next element, like scalars do once extracted
+  void next_in_seq() {
+    if (stack.empty())
+      return;
+    auto& curr = stack.top();
+    if (curr.valid() && !curr.is_seed() && curr.has_parent() && curr.parent_is_seq())
+      curr = curr.next_sibling();
+  }
+
+  template<typename T>
+  static bool read_scalar(ryml::csubstr str, T& val) {
+    if constexpr (std::is_floating_point_v<T>)
+      return read_floating(str, val);
+    else
+      return from_chars(str, &val);
+  }
+
+  // YAML 1.2 .inf/.nan, otherwise std::from_chars,
+  // falling back to c4 for anything it does not take (e.g. hex floats)
+  template<typename T>
+  static bool read_floating(ryml::csubstr str, T& val) {
+    bool neg = false;
+    ryml::csubstr num = str;
+    if (num.begins_with('+') || num.begins_with('-')) {
+      neg = num.begins_with('-');
+      num = num.sub(1);
+      if (num.begins_with('+') || num.begins_with('-'))
+        return false; // one sign only
+    }
+    if (num == ".inf" || num == ".Inf" || num == ".INF") {
+      val = neg ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity();
+      return true;
+    }
+    if (str == ".nan" || str == ".NaN" || str == ".NAN") {
+      val = std::numeric_limits<T>::quiet_NaN();
+      return true;
+    }
+#if defined(__cpp_lib_to_chars)
+    // std::from_chars takes a minus sign but not a plus sign
+    const char* first = str.begins_with('+') ? num.str : str.str;
+    const char* last = str.str + str.len;
+    auto res = std::from_chars(first, last, val);
+    if (res.ec == std::errc() && res.ptr == last)
+      return true;
+#endif
+    return from_chars(str, &val);
   }
 
   template<typename T>
@@ -39,7 +251,7 @@ public:
 
     if (expect_key) {
       if (curr.has_key()) {
-        from_chars(curr.key(), &val); // TODO: check return
+        read_scalar(curr.key(), val); // TODO: check return
         //std::cout << "got key " << val << std::endl;
       }
       else {
@@ -47,7 +259,7 @@ public:
       }
     }
     else if (curr.has_val()) {
-      from_chars(curr.val(), &val); // TODO: check return
+      read_scalar(curr.val(), val); // TODO: check return
       //std::cout << "got val " << val << std::endl;
       if (curr.has_parent() && curr.parent_is_seq()) {
         //std::cout << "next_sibling" << std::endl;
@@ -124,7 +336,9 @@ public:
     if (expect_key) {
       if (curr.has_key()) {
         if (len) {
-          curr.deserialize_key(ryml::fmt::base64(val, len));
+          auto str = curr.key();
+          if (serde::base64::decode(str.str, str.len, val, len) < 0)
+            std::cerr << "invalid base64 key" << std::endl;
         }
         //std::cout << "got key " << val << std::endl;
       }
@@ -134,7 +348,9 @@ public:
     }
     else if (curr.has_val()) {
       if (len) {
-        curr.deserialize_val(ryml::fmt::base64(val, len));
+        auto str = curr.val();
+        if (serde::base64::decode(str.str, str.len, val, len) < 0)
+          std::cerr << "invalid base64 value" << std::endl;
       }
       //std::cout << "got val " << val << std::endl;
       if (curr.has_parent() && curr.parent_is_seq()) {
@@ -163,7 +379,11 @@ public:
       }
     }
     else if (curr.has_val()) {
-      len = curr.val().len;
+      // bytes of a !!binary value, as told by deserialize_kind
+      if (curr.has_val_tag() && scalar_kind(curr.val(), false, curr.val_tag()) == serde::ValueKind::Bytes)
+        len = serde::base64::decoded_length(curr.val().str, curr.val().len);
+      else
+        len = curr.val().len;
     }
     else {
       //std::cerr << "no value to check length" << std::endl;
@@ -221,6 +441,31 @@ public:
     }
   }
 
+  // Memory ////////////////////////////////////////////////////////////////////
+  std::pmr::memory_resource* memory_resource() final { return object_resource; }
+
+  // Shared ////////////////////////////////////////////////////////////////////
+  // Objects deserialized from anchored values, found again by the aliases to them
+  std::shared_ptr<void> deserialize_shared_find(const std::type_info& type) final {
+    auto& curr = stack.top();
+    if (expect_key || !curr.valid() || curr.is_seed() || !tree.is_val_ref(curr.id()))
+      return nullptr;
+    auto it = shared.find(tree.val_ref(curr.id()));
+    if (it == shared.end() || *it->second.second != type) {
+      std::cerr << "alias to unknown anchor" << std::endl;
+      return nullptr;
+    }
+    if (curr.has_parent() && curr.parent_is_seq())
+      curr = curr.next_sibling();
+    return it->second.first;
+  }
+
+  void deserialize_shared_insert(const std::shared_ptr<void>& obj, const std::type_info& type) final {
+    auto& curr = stack.top();
+    if (expect_key || !curr.valid() || curr.is_seed() || !tree.has_val_anchor(curr.id()))
+      return;
+    shared[tree.val_anchor(curr.id())] = {obj, &type};
+  }
 
   void deserialize_seq_begin() final {
     auto curr = stack.top();
@@ -239,6 +484,7 @@ public:
       //return;
     //}
     stack.pop();
+    next_in_seq();
   }
 
   void deserialize_seq_size(size_t& val) final {
@@ -271,6 +517,7 @@ public:
 
   void deserialize_map_end() final {
     stack.pop();
+    next_in_seq();
   }
 
   void deserialize_map_key_begin() final {
@@ -321,7 +568,14 @@ public:
   }
 
   void deserialize_struct_field_begin(const char* name) final {
-    deserialize_map_key_find(name);
+    if (present_name == name) {
+      stack.push(present_field);
+      entry_find = true;
+      present_name = nullptr;
+    }
+    else {
+      deserialize_map_key_find(name);
+    }
     deserialize_map_value_begin();
   }
 
@@ -329,20 +583,275 @@ public:
     deserialize_map_value_end();
   }
 
+  bool deserialize_struct_field_present(const char* name) final {
+    present_name = nullptr;
+    auto curr = stack.top();
+    if (!curr.valid() || curr.is_seed() || !curr.has_parent() || !curr.parent_is_map())
+      return false;
+    auto child = curr.find_sibling({name, std::strlen(name)});
+    if (!child.valid() || child.is_seed() || !child.get())
+      return false;
+    present_name = name;
+    present_field = child;
+    return true;
+  }
+
+  // Transcode /////////////////////////////////////////////////////////////////
+  // Replays the tree from the current root into ser in one pass, no C++ objects in between.
+  // Scalars take the first type they read as: quoted strings stay strings, then null,
+  // booleans, integers and floats, !!str and !!binary tags are honored.
+  void transcode(serde::Serializer& ser) {
+    if (yaml.find('*') != std::string::npos)
+      tree.resolve(); // aliases and merge keys, node ids of the current root are kept
+    size_t root = stack.empty() ? tree.root_id() : stack.top().id();
+    std::string scratch;
+    if (tree.is_stream(root) && tree.num_children(root) == 1)
+      root = tree.first_child(root);
+    transcode_node(root, ser, scratch);
+  }
+
+  void transcode_node(size_t id, serde::Serializer& ser, std::string& scratch) {
+    if (tree.is_map(id)) {
+      ser.serialize_map_begin();
+      for (size_t child = tree.first_child(id); child != ryml::NONE; child = tree.next_sibling(child)) {
+        ser.serialize_map_key_begin();
+        transcode_scalar(tree.key(child), tree.is_key_quoted(child),
+                         tree.has_key_tag(child) ? tree.key_tag(child) : ryml::csubstr{}, ser, scratch);
+        ser.serialize_map_key_end();
+        ser.serialize_map_value_begin();
+        transcode_node(child, ser, scratch);
+        ser.serialize_map_value_end();
+      }
+      ser.serialize_map_end();
+    }
+    else if (tree.is_seq(id) || tree.is_stream(id)) {
+      ser.serialize_seq_begin();
+      for (size_t child = tree.first_child(id); child != ryml::NONE; child = tree.next_sibling(child))
+        transcode_node(child, ser, scratch);
+      ser.serialize_seq_end();
+    }
+    else if (tree.has_val(id)) {
+      transcode_scalar(tree.val(id), tree.is_val_quoted(id),
+                       tree.has_val_tag(id) ? tree.val_tag(id) : ryml::csubstr{}, ser, scratch);
+    }
+    else {
+      ser.serialize_none();
+    }
+  }
+
+  void transcode_scalar(ryml::csubstr str, bool quoted, ryml::csubstr tag,
+                        serde::Serializer& ser, std::string& scratch) {
+    switch (scalar_kind(str, quoted, tag)) {
+      case serde::ValueKind::Null: return ser.serialize_none();
+      case serde::ValueKind::Bool: return ser.serialize_bool(str.begins_with_any("tT"));
+      case serde::ValueKind::Int: {
+        int64_t i = 0;
+        read_integer(str, i);
+        return ser.serialize_i64(i);
+      }
+      case serde::ValueKind::UInt: {
+        uint64_t u = 0;
+        read_integer(str, u);
+        return ser.serialize_u64(u);
+      }
+      case serde::ValueKind::Float: {
+        double d = 0;
+        read_floating(str, d);
+        return ser.serialize_double(d);
+      }
+      case serde::ValueKind::Bytes: {
+        scratch.resize(serde::base64::decoded_length(str.str, str.len));
+        const auto len = serde::base64::decode(str.str, str.len, scratch.data(), scratch.size());
+        return ser.serialize_bytes(scratch.data(), static_cast<size_t>(len));
+      }
+      default:
+        scratch.assign(str.str, str.len);
+        return ser.serialize_cstr(scratch.c_str());
+    }
+  }
+
+  // Kind ////////////////////////////////////////////////////////////////////////
+  serde::ValueKind deserialize_kind() final {
+    auto& curr = stack.top();
+    if (!curr.valid() || curr.is_seed() || !curr.get())
+      return serde::ValueKind::Unknown;
+    const size_t id = curr.id();
+    if (expect_key) {
+      if (!tree.has_key(id))
+        return serde::ValueKind::Unknown;
+      return scalar_kind(tree.key(id), tree.is_key_quoted(id), tree.has_key_tag(id) ? tree.key_tag(id) : ryml::csubstr{});
+    }
+    if (tree.is_map(id))
+      return serde::ValueKind::Map;
+    if (tree.is_seq(id))
+      return serde::ValueKind::Seq;
+    if (!tree.has_val(id))
+      return serde::ValueKind::Null;
+    return scalar_kind(tree.val(id), tree.is_val_quoted(id), tree.has_val_tag(id) ? tree.val_tag(id) : ryml::csubstr{});
+  }
+
+  // Scalars take the first kind they read as: quoted strings stay strings, then null,
+  // booleans, integers and floats; !!str and valid !!binary tags are honored.
+  static serde::ValueKind scalar_kind(ryml::csubstr str, bool quoted, ryml::csubstr tag) {
+    if (tag == "!!binary") {
+      char none;
+      return serde::base64::decode(str.str, str.len, &none, 0) < 0 ? serde::ValueKind::Str : serde::ValueKind::Bytes;
+    }
+    if (quoted || tag == "!!str")
+      return serde::ValueKind::Str;
+    if (str.empty() || str == "~" || str == "null" || str == "Null" || str == "NULL")
+      return serde::ValueKind::Null;
+    if (str == "true" || str == "True" || str == "TRUE" || str == "false" || str == "False" || str == "FALSE")
+      return serde::ValueKind::Bool;
+    int64_t i = 0;
+    if (read_integer(str, i))
+      return serde::ValueKind::Int;
+    uint64_t u = 0;
+    if (read_integer(str, u))
+      return serde::ValueKind::UInt;
+    // only digits or a dot make a float, so words like "inf" or "nan" stay strings
+    double d = 0;
+    if (str.first_of("0123456789.") != ryml::npos && read_floating(str, d))
+      return serde::ValueKind::Float;
+    return serde::ValueKind::Str;
+  }
+
+  // Decimal integer of the whole string, with an optional sign
+  template<typename T>
+  static bool read_integer(ryml::csubstr str, T& val) {
+    const char* first = str.begins_with('+') ? str.str + 1 : str.str;
+    const char* last = str.str + str.len;
+    if (first != str.str && first != last && (*first == '-' || *first == '+'))
+      return false; // one sign only
+    auto res = std::from_chars(first, last, val);
+    return res.ec == std::errc() && res.ptr == last;
+  }
+
 };
 
 
 namespace detail {
 
-auto DeserializerNew(std::string&& str) -> std::unique_ptr<serde::Deserializer>
+auto DeserializerNew(std::string&& str, const ParseOptions& options) -> std::unique_ptr<serde::Deserializer>
 {
-  return std::make_unique<YamlDeserializer>(std::move(str));
+  return std::make_unique<YamlDeserializer>(std::move(str), options);
 }
 
 auto DeserializerParse(serde::Deserializer* de) -> cpp::result<void, serde::Error>
 {
   auto yamlde = static_cast<YamlDeserializer*>(de);
-  yamlde->parse();
+  return yamlde->parse();
+}
+
+auto DeserializerCapacity(serde::Deserializer* de) -> Capacity
+{
+  auto yamlde = static_cast<YamlDeserializer*>(de);
+  return yamlde->reservation();
+}
+
+auto DeserializerSize(serde::Deserializer* de) -> Capacity
+{
+  auto yamlde = static_cast<YamlDeserializer*>(de);
+  return yamlde->size();
+}
+
+auto DeserializerParseAt(serde::Deserializer* de, std::string_view path) -> cpp::result<void, serde::Error>
+{
+  auto yamlde = static_cast<YamlDeserializer*>(de);
+  auto parsed = yamlde->parse();
+  if (!parsed)
+    return parsed;
+  try {
+    if (!yamlde->seek(path))
+      return cpp::fail(serde::Error{serde::Error::Kind::Invalid, 0, 0, "path not found: " + std::string(path)});
+  }
+  catch (ParseError& e) {
+    return cpp::fail(std::move(e.error));
+  }
+  return {};
+}
+
+auto PathSection(std::string_view yaml, std::string_view path) -> std::string_view
+{
+  if (path.size() < 2 || path.front() != '/')
+    return yaml;
+  const auto key = unescape_token(path.substr(1, path.find('/', 1) - 1));
+
+  // Only top-level lines (column 0) are looked at: the section of key starts at its line
+  // and ends at the next top-level key, so nested and indented text is skipped unread.
+  // Anything that is not a plain block mapping at the root falls back to the whole input.
+  size_t begin = std::string_view::npos;
+  size_t pos = 0;
+  bool seen_keys = false;
+  while (pos < yaml.size()) {
+    const auto eol = yaml.find('\n', pos);
+    const auto line = yaml.substr(pos, eol == std::string_view::npos ? eol : eol - pos);
+    const auto next = eol == std::string_view::npos ? yaml.size() : eol + 1;
+
+    const bool marker = line.substr(0, 3) == "---" || line.substr(0, 3) == "...";
+    if (line.empty() || line.front() == ' ' || line.front() == '\t' || line.front() == '#'
+        || line.front() == '\r' || (line.front() == '-' && !marker)) {
+      // nested, blank, comment or block sequence entry of the current key
+    }
+    else if (begin != std::string_view::npos) {
+      if (line.front() == ']' || line.front() == '}')
+        return yaml; // multi-line flow collection
+      const auto section = yaml.substr(begin, pos - begin);
+      return section.find('*') == std::string_view::npos ? section : yaml;
+    }
+    else if (marker) {
+      const auto content = line.find_first_not_of(' ', 3);
+      if (seen_keys || (content != std::string_view::npos && line[content] != '#' && line[content] != '\r'))
+        return yaml; // next document, or document content on the marker line
+    }
+    else if (line.front() == '%') {
+      // directive
+    }
+    else if (std::strchr("[{|>!&*?", line.front())) {
+      return yaml; // not a block mapping at the root
+    }
+    else {
+      if (line.substr(0, key.size()) == key && line.substr(key.size(), 1) == ":")
+        begin = pos;
+      seen_keys = true;
+    }
+    pos = next;
+  }
+
+  if (begin == std::string_view::npos)
+    return yaml;
+  const auto section = yaml.substr(begin);
+  return section.find('*') == std::string_view::npos ? section : yaml;
+}
+
+auto DeserializerReset(serde::Deserializer* de, std::string&& str) -> cpp::result<void, serde::Error>
+{
+  auto yamlde = static_cast<YamlDeserializer*>(de);
+  yamlde->reset(std::move(str));
+  return yamlde->parse();
+}
+
+auto DeserializerRun(serde::Deserializer* de, void (*run)(serde::Deserializer&, void*), void* obj)
+    -> cpp::result<void, serde::Error>
+{
+  try {
+    run(*de, obj);
+  }
+  catch (ParseError& e) {
+    return cpp::fail(std::move(e.error));
+  }
+  return {};
+}
+
+auto DeserializerTranscode(serde::Deserializer* de, serde::Serializer& ser) -> cpp::result<void, serde::Error>
+{
+  auto yamlde = static_cast<YamlDeserializer*>(de);
+  try {
+    yamlde->transcode(ser);
+  }
+  catch (ParseError& e) {
+    return cpp::fail(std::move(e.error));
+  }
   return {};
 }
 
@@ -1,20 +1,56 @@
 #include "serde_yaml/ser_yaml.h"
 
 #include <stack>
+#include <map>
+#include <string>
+#include <typeindex>
+#include <cmath>
+#include <charconv>
 #include <iostream>
 
 #include <ryml_std.hpp>
 #include <ryml.hpp>
 #include <c4/format.hpp>
 
+#include "serde/base64.h"
+#include "allocator.h"
+
 ////////////////////////////////////////////////////////////////////////////////
 // Serde YAML
 ////////////////////////////////////////////////////////////////////////////////
 namespace serde_yaml {
 
+// Flags forcing a key or value to be emitted as a plain scalar,
+// named KEY_PLAIN/VAL_PLAIN since rapidyaml 0.6 and _WIP_KEY_PLAIN/_WIP_VAL_PLAIN before.
+template<typename NodeTypeE>
+constexpr auto key_plain_flag(int) -> decltype(NodeTypeE::KEY_PLAIN) { return NodeTypeE::KEY_PLAIN; }
+template<typename NodeTypeE>
+constexpr auto key_plain_flag(long) -> decltype(NodeTypeE::_WIP_KEY_PLAIN) { return NodeTypeE::_WIP_KEY_PLAIN; }
+template<typename NodeTypeE>
+constexpr auto val_plain_flag(int) -> decltype(NodeTypeE::VAL_PLAIN) { return NodeTypeE::VAL_PLAIN; }
+template<typename NodeTypeE>
+constexpr auto val_plain_flag(long) -> decltype(NodeTypeE::_WIP_VAL_PLAIN) { return NodeTypeE::_WIP_VAL_PLAIN; }
+
+// Flag marking a container to be emitted in flow style on a single line,
+// named FLOW_SL since rapidyaml 0.6 and _WIP_STYLE_FLOW_SL before.
+template<typename NodeTypeE>
+constexpr auto flow_sl_flag(int) -> decltype(NodeTypeE::FLOW_SL) { return NodeTypeE::FLOW_SL; }
+template<typename NodeTypeE>
+constexpr auto flow_sl_flag(long) -> decltype(NodeTypeE::_WIP_STYLE_FLOW_SL) { return NodeTypeE::_WIP_STYLE_FLOW_SL; }
+template<typename NodeTypeE>
+constexpr NodeTypeE flow_sl_flag(...) {
+  static_assert(sizeof(NodeTypeE) == 0, "this rapidyaml has neither FLOW_SL nor _WIP_STYLE_FLOW_SL to emit the flow styles of EmitOptions");
+  return NodeTypeE{};
+}
+
 class YamlSerializer final : public serde::Serializer {
 public:
-  YamlSerializer() {
+  YamlSerializer(const Capacity& capacity, std::pmr::memory_resource* tree_resource)
+      : allocator{{}, tree_resource}, tree(detail::TreeCallbacks(ryml::get_callbacks(), &allocator)) {
+    if (capacity.nodes)
+      tree.reserve(capacity.nodes);
+    if (capacity.arena)
+      tree.reserve_arena(capacity.arena);
     stack.push(tree.rootref());
   }
 
@@ -32,18 +68,59 @@ public:
   void serialize_u32(uint32_t v) final { serialize_scalar(v); }
   void serialize_i64(int64_t v) final { serialize_scalar(v); }
   void serialize_u64(uint64_t v) final { serialize_scalar(v); }
-  void serialize_float(float v) final { serialize_scalar(v); }
-  void serialize_double(double v) final { serialize_scalar(v); }
+  void serialize_float(float v) final { serialize_floating(v); }
+  void serialize_double(double v) final { serialize_floating(v); }
   void serialize_char(char v) final { serialize_scalar(v); }
   void serialize_uchar(unsigned char v) final { serialize_scalar(v); }
   void serialize_cstr(const char* v) final { serialize_scalar(v); }
   void serialize_bytes(const void* val, size_t len) final {
-    serialize_scalar(ryml::fmt::cbase64(val, len));
+    auto str = tree.alloc_arena(serde::base64::encoded_length(len));
+    serde::base64::encode(val, len, str.str);
+    serialize_scalar_str(str);
   }
 
   // Optional //////////////////////////////////////////////////////////////////
   void serialize_none() final { serialize_scalar("null"); }
 
+  // Shared ////////////////////////////////////////////////////////////////////
+  // The first occurrence of an object is serialized as usual and its node remembered,
+  // later occurrences get an alias to it and the anchor is added to the first node then,
+  // so objects reached only once are emitted as before.
+  bool serialize_shared_begin(const void* ptr, const std::type_info& type) final {
+    auto curr = stack.top();
+    const SharedKey key{ptr, type};
+    const bool in_seq = curr.is_seq();
+    if (!in_seq && curr.has_parent() && curr.parent_is_map() && !curr.has_key()) {
+      shared_pending.push({key, ryml::NONE, false}); // map key, never aliased
+      return false;
+    }
+
+    auto it = shared.find(key);
+    if (it == shared.end()) {
+      shared_pending.push({key, curr.id(), in_seq});
+      return false;
+    }
+
+    // names are copied to the arena on each use, as arena growth moves earlier strings
+    auto& [node, anchor] = it->second;
+    const auto name = "*id" + std::to_string(anchor ? anchor : ++anchors);
+    if (!anchor) {
+      anchor = anchors;
+      tree.set_val_anchor(node, tree.copy_to_arena(ryml::csubstr(name.data() + 1, name.size() - 1)));
+    }
+    const auto ref = tree.copy_to_arena(ryml::csubstr(name.data(), name.size()));
+    serialize_scalar_str(ref);
+    tree.set_val_ref(in_seq ? tree.last_child(curr.id()) : curr.id(), ref);
+    return true;
+  }
+
+  void serialize_shared_end() final {
+    const auto [key, slot, in_seq] = shared_pending.top();
+    shared_pending.pop();
+    if (slot != ryml::NONE)
+      shared.emplace(key, Shared{in_seq ? tree.last_child(slot) : slot, 0});
+  }
+
   // Sequence //////////////////////////////////////////////////////////////////
   void serialize_seq_begin() final {
     auto curr = stack.top();
@@ -139,27 +216,122 @@ public:
     }
   }
 
-  std::string emit() const {
+  // Shortest representation that reads back to the same value,
+  // formatted on the stack and copied once into the tree's arena
+  template<typename T>
+  void serialize_floating(T val) {
+    char buf[32];
+    ryml::csubstr str;
+    if (std::isnan(val))
+      str = ".nan";
+    else if (std::isinf(val) && val < 0)
+      str = "-.inf";
+    else if (std::isinf(val))
+      str = ".inf";
+    else {
+#if defined(__cpp_lib_to_chars)
+      auto res = std::to_chars(buf, buf + sizeof(buf), val);
+      str = {buf, static_cast<size_t>(res.ptr - buf)};
+#else
+      size_t len = to_chars(ryml::substr(buf, sizeof(buf)), val);
+      str = {buf, std::min(len, sizeof(buf))};
+#endif
+    }
+    // the YAML 1.2 forms would be quoted for their leading dot or dash, and read as strings then
+    serialize_scalar_str(tree.copy_to_arena(str), !std::isfinite(val));
+  }
+
+  // Same as serialize_scalar for a string already owned by the tree, set without copying,
+  // plain to emit it without quotes whatever it looks like
+  void serialize_scalar_str(ryml::csubstr str, bool plain = false) {
+    auto curr = stack.top();
+    size_t node = curr.id();
+    bool key = false;
+    if (curr.is_seq()) {
+      curr.append_child().set_val(str);
+      node = curr.last_child().id();
+    }
+    else if (curr.has_parent() && curr.parent_is_map()) {
+      if (!curr.has_key()) {
+        curr.set_key(str);
+        key = true;
+      }
+      else if (!curr.has_val())
+        curr.set_val(str);
+      else {
+        curr.append_sibling().set_key(str);
+        stack.push(curr.next_sibling());
+        node = curr.next_sibling().id();
+        key = true;
+      }
+    }
+    else {
+      curr.set_val(str);
+    }
+    if (plain)
+      tree._add_flags(node, key ? key_plain_flag<ryml::NodeType_e>(0) : val_plain_flag<ryml::NodeType_e>(0));
+  }
+
+  Capacity capacity() const {
+    return {tree.size(), tree.arena_size()};
+  }
+
+  std::string emit(const EmitOptions& options) {
+    if (options.flow_scalar_containers || options.flow_max_nodes)
+      mark_flow(tree.root_id(), options);
     return ryml::emitrs<std::string>(tree);
   }
 
+  // Marks the containers of the subtree of id to be emitted in flow style
+  // according to the options, returns the number of descendants of id
+  size_t mark_flow(size_t id, const EmitOptions& options) {
+    size_t descendants = 0;
+    bool scalars_only = true;
+    for (size_t child = tree.first_child(id); child != ryml::NONE; child = tree.next_sibling(child)) {
+      if (tree.is_container(child))
+        scalars_only = false;
+      descendants += 1 + mark_flow(child, options);
+    }
+    if (tree.is_container(id) && descendants > 0) {
+      if ((options.flow_scalar_containers && scalars_only) || descendants <= options.flow_max_nodes)
+        tree._add_flags(id, flow_sl_flag<ryml::NodeType_e>(0));
+    }
+    return descendants;
+  }
+
 private:
+  using SharedKey = std::pair<const void*, std::type_index>;
+  struct Shared { size_t node; size_t anchor; }; // anchor number, 0 until aliased
+  struct SharedPending { SharedKey key; size_t slot; bool in_seq; };
+
+  detail::TreeAllocator allocator;
   ryml::Tree tree;
   std::stack<ryml::NodeRef> stack;
+  std::map<SharedKey, Shared> shared;
+  std::stack<SharedPending> shared_pending;
+  size_t anchors = 0;
 };
 
 
 namespace detail {
 
-auto SerializerNew() -> std::unique_ptr<serde::Serializer>
+auto SerializerNew(const Capacity& capacity, std::pmr::memory_resource* tree_resource)
+    -> std::unique_ptr<serde::Serializer>
 {
-  return std::make_unique<YamlSerializer>();
+  return std::make_unique<YamlSerializer>(capacity, tree_resource);
+}
+
+auto SerializerCapacity(serde::Serializer* ser) -> Capacity
+{
+  auto yamlser = static_cast<YamlSerializer*>(ser);
+  return yamlser->capacity();
 }
 
-auto SerializerOutput(serde::Serializer* ser) -> cpp::result<std::string, serde::Error>
+auto SerializerOutput(serde::Serializer* ser, const EmitOptions& options)
+    -> cpp::result<std::string, serde::Error>
 {
   auto yamlser = static_cast<YamlSerializer*>(ser);
-  return yamlser->emit();
+  return yamlser->emit(options);
 }
 
 } // namespace detail
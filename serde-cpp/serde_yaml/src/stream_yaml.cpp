@@ -0,0 +1,108 @@
+#include "serde_yaml/stream_yaml.h"
+
+#include <cstring>
+#include <istream>
+
+////////////////////////////////////////////////////////////////////////////////
+// Serde YAML streaming
+////////////////////////////////////////////////////////////////////////////////
+namespace serde_yaml {
+
+namespace {
+
+enum class Marker { None, DocumentStart, DocumentEnd };
+
+// `---` or `...` at the start of a line, followed by a blank or the end of the line
+Marker document_marker(std::string_view line)
+{
+  if (line.size() < 3 || (line.size() > 3 && line[3] != ' ' && line[3] != '\t' && line[3] != '\r'))
+    return Marker::None;
+  if (line.compare(0, 3, "---") == 0)
+    return Marker::DocumentStart;
+  if (line.compare(0, 3, "...") == 0)
+    return Marker::DocumentEnd;
+  return Marker::None;
+}
+
+// anything but blank lines, comments and directives
+bool has_content(std::string_view line)
+{
+  auto pos = line.find_first_not_of(" \t\r");
+  return pos != std::string_view::npos && line[pos] != '#' && !(pos == 0 && line[0] == '%');
+}
+
+} // namespace
+
+bool DocumentSplitter::next(std::string& document)
+{
+  document.clear();
+  bool content = false;
+  if (!pending.empty()) {
+    content = has_content(pending);
+    document.swap(pending);
+  }
+
+  while (std::getline(input, line)) {
+    const auto marker = document_marker(line);
+    if (marker == Marker::None) {
+      content = content || has_content(line);
+      document += line;
+      document += '\n';
+      continue;
+    }
+    if (marker == Marker::DocumentStart && line.size() > 3) {
+      // content on the marker line, e.g. `--- {a: 1}`, belongs to the next document
+      pending.assign(line, 4, std::string::npos);
+      pending += '\n';
+    }
+    if (content)
+      return true;
+    // nothing in this document yet, keep going with the next one
+    document.clear();
+    if (!pending.empty()) {
+      content = has_content(pending);
+      document.swap(pending);
+    }
+  }
+
+  return content;
+}
+
+auto split_documents(std::string_view input) -> std::vector<std::string_view>
+{
+  std::vector<std::string_view> documents;
+  size_t begin = 0;      // start of the current document
+  bool content = false;  // whether the current document has content yet
+
+  const char* const data = input.data();
+  size_t pos = 0;
+  while (pos < input.size()) {
+    auto eol = static_cast<const char*>(std::memchr(data + pos, '\n', input.size() - pos));
+    const size_t end = eol ? static_cast<size_t>(eol - data) : input.size();
+    const std::string_view line = input.substr(pos, end - pos);
+    const size_t next = eol ? end + 1 : end;
+
+    const auto marker = document_marker(line);
+    if (marker == Marker::None) {
+      content = content || has_content(line);
+    }
+    else {
+      if (content)
+        documents.push_back(input.substr(begin, pos - begin));
+      content = false;
+      begin = next;
+      if (marker == Marker::DocumentStart && line.size() > 3) {
+        // content on the marker line, e.g. `--- {a: 1}`, belongs to the next document
+        begin = pos + 4;
+        content = has_content(line.substr(4));
+      }
+    }
+    pos = next;
+  }
+  if (content)
+    documents.push_back(input.substr(begin));
+
+  return documents;
+}
+
+} // namespace serde_yaml
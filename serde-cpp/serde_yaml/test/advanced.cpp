@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <memory_resource>
+#include <sstream>
+
 #include "serde/std.h"
 #include "serde/serde.h"
 #include "serde_yaml/serde_yaml.h"
@@ -40,6 +44,160 @@ TEST(Advanced, PointSerialize)
 )");
 }
 
+TEST(Advanced, PointSerializeFlow)
+{
+  types::Point point{ 10, 20 };
+  serde_yaml::EmitOptions options;
+  options.flow_scalar_containers = true;
+  std::string block = serde_yaml::to_string(point).value();
+  std::string flow = serde_yaml::to_string(point, options).value();
+  EXPECT_EQ(flow.find("- 10\n"), std::string::npos);
+  EXPECT_LT(std::count(flow.begin(), flow.end(), '\n'), std::count(block.begin(), block.end(), '\n'));
+}
+
+TEST(Advanced, FlowScalarContainers)
+{
+  using Type = std::map<std::string, std::vector<int>>;
+  const Type val = {{"a", {1, 2, 3}}, {"b", {}}, {"c", {4}}};
+  serde_yaml::EmitOptions options;
+  options.flow_scalar_containers = true;
+  auto str = serde_yaml::to_string(val, options).value();
+  EXPECT_EQ(std::count(str.begin(), str.end(), '\n'), 3);
+  auto de_val = serde_yaml::from_str<Type>(std::move(str)).value();
+  EXPECT_EQ(de_val, val);
+}
+
+TEST(Advanced, FlowMaxNodes)
+{
+  using Type = std::vector<std::vector<int>>;
+  const Type val = {{1, 2}, {3, 4}, std::vector<int>(100, 5)};
+  serde_yaml::EmitOptions options;
+  options.flow_max_nodes = 8;
+  auto str = serde_yaml::to_string(val, options).value();
+  // the small sequences fit on their own line, the large one stays in block style
+  EXPECT_EQ(std::count(str.begin(), str.end(), '\n'), 2 + 100);
+  auto de_val = serde_yaml::from_str<Type>(std::move(str)).value();
+  EXPECT_EQ(de_val, val);
+}
+
+TEST(Advanced, Capacity)
+{
+  using Type = std::map<std::string, std::vector<double>>;
+  const Type val = {{"a", {1.5, 2.5}}, {"b", std::vector<double>(50, 0.25)}};
+  const auto str = serde_yaml::to_string(val).value();
+  // sized from the last serialization of Type, or from an explicit hint
+  EXPECT_EQ(serde_yaml::to_string(val).value(), str);
+  serde_yaml::EmitOptions emit;
+  emit.capacity = {4, 16};
+  EXPECT_EQ(serde_yaml::to_string(val, emit).value(), str);
+  // sized from the input, or from an explicit hint
+  EXPECT_EQ(serde_yaml::from_str<Type>(std::string(str)).value(), val);
+  serde_yaml::ParseOptions parse;
+  parse.capacity = {2, 0};
+  EXPECT_EQ(serde_yaml::from_str<Type>(std::string(str), parse).value(), val);
+
+  // the estimate leaves room for every node, block sequences of maps and nested flow included
+  for (std::string yaml : {str, std::string("- a: 1\n  b: {c: [1, 2]}\n- d: 3\n"),
+                           std::string("[[1,2],[3],{a: [4]}]"), std::string("k:\n- - x\n  - y\n")}) {
+    auto de = serde_yaml::detail::DeserializerNew(std::string(yaml));
+    ASSERT_TRUE(serde_yaml::detail::DeserializerParse(de.get())) << yaml;
+    EXPECT_LE(serde_yaml::detail::DeserializerSize(de.get()).nodes,
+              serde_yaml::detail::DeserializerCapacity(de.get()).nodes) << yaml;
+  }
+  // an explicit hint is reserved as given
+  auto de = serde_yaml::detail::DeserializerNew(std::string(str), parse);
+  ASSERT_TRUE(serde_yaml::detail::DeserializerParse(de.get()));
+  EXPECT_EQ(serde_yaml::detail::DeserializerCapacity(de.get()).nodes, 2u);
+  EXPECT_GT(serde_yaml::detail::DeserializerSize(de.get()).nodes, 2u);
+}
+
+// Counts the bytes allocated from it, on top of a monotonic buffer
+class CountingResource : public std::pmr::memory_resource {
+public:
+  size_t allocated = 0;
+
+private:
+  std::pmr::monotonic_buffer_resource buffer;
+
+  void* do_allocate(size_t bytes, size_t alignment) override {
+    allocated += bytes;
+    return buffer.allocate(bytes, alignment);
+  }
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+    buffer.deallocate(p, bytes, alignment);
+  }
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+TEST(Advanced, TreeResource)
+{
+  using Type = std::map<std::string, std::vector<double>>;
+  const Type val = {{"a", {1.5, 2.5}}, {"b", std::vector<double>(50, 0.25)}};
+
+  CountingResource emit_resource;
+  serde_yaml::EmitOptions emit;
+  emit.tree_resource = &emit_resource;
+  auto str = serde_yaml::to_string(val, emit).value();
+  EXPECT_EQ(str, serde_yaml::to_string(val).value());
+  EXPECT_GT(emit_resource.allocated, 0u);
+
+  CountingResource parse_resource;
+  serde_yaml::ParseOptions parse;
+  parse.tree_resource = &parse_resource;
+  EXPECT_EQ(serde_yaml::from_str<Type>(std::move(str), parse).value(), val);
+  EXPECT_GT(parse_resource.allocated, 0u);
+}
+
+// serde_yaml_test links the global operator new hook, so all phases are counted
+TEST(Advanced, Allocations)
+{
+  using Type = std::vector<std::string>;
+  const Type val(10, std::string(100, 'x'));
+
+  std::string str;
+  auto ser = serde_yaml::instrument::measure([&] { str = serde_yaml::to_string(val).value(); });
+  EXPECT_GT(ser.tree.count, 0u);
+  EXPECT_GE(ser.emit.bytes, str.size());
+  EXPECT_EQ(ser.parse.count + ser.objects.count, 0u);
+
+  Type out;
+  auto de = serde_yaml::instrument::measure([&] { out = serde_yaml::from_str<Type>(std::string(str)).value(); });
+  EXPECT_EQ(out, val);
+  EXPECT_GT(de.parse.count, 0u);
+  EXPECT_GE(de.objects.count, val.size());
+  EXPECT_GE(de.objects.bytes, val.size() * 100);
+  EXPECT_EQ(de.tree.count + de.emit.count, 0u);
+  EXPECT_EQ(de.total().count, de.parse.count + de.objects.count);
+
+  // nothing counted outside of measure
+  serde_yaml::instrument::Stats stats;
+  {
+    serde_yaml::instrument::Counter counter(stats);
+  }
+  EXPECT_EQ(serde_yaml::to_string(val).value(), str);
+  EXPECT_EQ(stats.total().count, 0u);
+}
+
+TEST(Advanced, AllocationsStream)
+{
+  const std::string yaml = "--- [" + std::string(100, 'x') + "]\n--- [" + std::string(100, 'y') + "]\n";
+
+  auto multi = serde_yaml::instrument::measure([&] {
+    EXPECT_EQ(serde_yaml::from_str_multi<std::vector<std::string>>(yaml, 1).value().size(), 2u);
+  });
+  EXPECT_GT(multi.parse.count, 0u);
+  EXPECT_GE(multi.objects.bytes, 2 * 100u);
+
+  std::istringstream input(yaml);
+  auto stream = serde_yaml::instrument::measure([&] {
+    for (auto& doc : serde_yaml::from_stream<std::vector<std::string>>(input))
+      EXPECT_TRUE(doc.has_value());
+  });
+  EXPECT_GT(stream.parse.count, 0u);
+  EXPECT_GE(stream.objects.bytes, 2 * 100u);
+}
 
 TEST(Advanced, PointDeserialize)
 {
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "serde/base64.h"
+#include "serde/serde.h"
+#include "serde_yaml/serde_yaml.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Base64 codec
+///////////////////////////////////////////////////////////////////////////////
+
+using serde::base64::Impl;
+
+static std::vector<Impl> supported_impls()
+{
+  std::vector<Impl> impls = {Impl::Scalar};
+  if (serde::base64::best_impl() != Impl::Scalar) impls.push_back(Impl::SSSE3);
+  if (serde::base64::best_impl() == Impl::AVX2) impls.push_back(Impl::AVX2);
+  return impls;
+}
+
+TEST(Base64, Rfc4648Vectors)
+{
+  const char* vectors[][2] = {
+    {"", ""}, {"f", "Zg=="}, {"fo", "Zm8="}, {"foo", "Zm9v"},
+    {"foob", "Zm9vYg=="}, {"fooba", "Zm9vYmE="}, {"foobar", "Zm9vYmFy"},
+  };
+  for (const auto& [raw, encoded] : vectors) {
+    const size_t len = std::strlen(raw);
+    std::string enc(serde::base64::encoded_length(len), '\0');
+    serde::base64::encode(raw, len, enc.data());
+    EXPECT_EQ(enc, encoded);
+    std::string dec(len, '\0');
+    EXPECT_EQ(serde::base64::decode(enc.data(), enc.size(), dec.data(), dec.size()), ptrdiff_t(len));
+    EXPECT_EQ(dec, raw);
+  }
+}
+
+TEST(Base64, AllImplsMatchScalar)
+{
+  std::mt19937 rng(42);
+  for (size_t len = 0; len < 300; len++) {
+    std::vector<uint8_t> raw(len);
+    for (auto& b : raw) b = static_cast<uint8_t>(rng());
+    std::string expected(serde::base64::encoded_length(len), '\0');
+    serde::base64::encode(raw.data(), len, expected.data(), Impl::Scalar);
+    for (Impl impl : supported_impls()) {
+      std::string enc(expected.size(), '\0');
+      serde::base64::encode(raw.data(), len, enc.data(), impl);
+      ASSERT_EQ(enc, expected) << "len " << len;
+      std::vector<uint8_t> dec(len);
+      ASSERT_EQ(serde::base64::decode(enc.data(), enc.size(), dec.data(), dec.size(), impl), ptrdiff_t(len));
+      ASSERT_EQ(dec, raw) << "len " << len;
+    }
+  }
+}
+
+TEST(Base64, DecodeIntoSmallerBuffer)
+{
+  const std::string enc = "Zm9vYmFyIGJheiBxdXggcXV1eCBjb3JnZSBncmF1bHQgZ2FycGx5";
+  for (Impl impl : supported_impls()) {
+    char dec[8] = {0};
+    EXPECT_EQ(serde::base64::decode(enc.data(), enc.size(), dec, 7, impl), 7);
+    EXPECT_STREQ(dec, "foobar ");
+  }
+}
+
+TEST(Base64, DecodeInvalid)
+{
+  char dec[64];
+  for (Impl impl : supported_impls()) {
+    EXPECT_EQ(serde::base64::decode("Zm9", 3, dec, sizeof(dec), impl), -1);
+    EXPECT_EQ(serde::base64::decode("Zm=v", 4, dec, sizeof(dec), impl), -1);
+    EXPECT_EQ(serde::base64::decode("Zg==Zm9v", 8, dec, sizeof(dec), impl), -1);
+    std::string enc(48, 'A');
+    enc[37] = '*';
+    EXPECT_EQ(serde::base64::decode(enc.data(), enc.size(), dec, sizeof(dec), impl), -1);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// YAML bytes
+///////////////////////////////////////////////////////////////////////////////
+
+struct Blob {
+  std::array<uint8_t, 100> data;
+};
+
+template<>
+void serde::serialize(serde::Serializer& ser, const Blob& blob)
+{
+  ser.serialize_bytes(blob.data.data(), blob.data.size());
+}
+
+template<>
+void serde::deserialize(serde::Deserializer& de, Blob& blob)
+{
+  de.deserialize_bytes(blob.data.data(), blob.data.size());
+}
+
+TEST(Base64, YamlBytes)
+{
+  Blob val;
+  for (size_t i = 0; i < val.data.size(); i++) val.data[i] = static_cast<uint8_t>(i * 7);
+  auto str = serde_yaml::to_string(val).value();
+  std::string expected(serde::base64::encoded_length(val.data.size()), '\0');
+  serde::base64::encode(val.data.data(), val.data.size(), expected.data());
+  EXPECT_EQ(str, expected + "\n");
+  auto de_val = serde_yaml::from_str<Blob>(std::move(str)).value();
+  EXPECT_EQ(de_val.data, val.data);
+}
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <limits>
+
 #include "serde/serde.h"
 #include "serde_yaml/serde_yaml.h"
 
@@ -153,6 +156,43 @@ TEST(Builtin, Double)
   EXPECT_DOUBLE_EQ(de_val, val);
 }
 
+TEST(Builtin, Double_ShortestRoundTrip)
+{
+  double val = 0.1 + 0.2;
+  auto str = serde_yaml::to_string(val).value();
+  EXPECT_STREQ(str.c_str(), "0.30000000000000004\n");
+  auto de_val = serde_yaml::from_str<double>(std::move(str)).value();
+  EXPECT_EQ(de_val, val);
+}
+
+TEST(Builtin, Double_Extremes)
+{
+  for (double val : {std::numeric_limits<double>::max(), std::numeric_limits<double>::min(),
+                     std::numeric_limits<double>::denorm_min(), -1e-300, 123456789.125}) {
+    auto str = serde_yaml::to_string(val).value();
+    auto de_val = serde_yaml::from_str<double>(std::move(str)).value();
+    EXPECT_EQ(de_val, val);
+  }
+}
+
+TEST(Builtin, Float_Infinity)
+{
+  float val = -std::numeric_limits<float>::infinity();
+  auto str = serde_yaml::to_string(val).value();
+  EXPECT_STREQ(str.c_str(), "-.inf\n");
+  auto de_val = serde_yaml::from_str<float>(std::move(str)).value();
+  EXPECT_EQ(de_val, val);
+}
+
+TEST(Builtin, Double_NaN)
+{
+  double val = std::numeric_limits<double>::quiet_NaN();
+  auto str = serde_yaml::to_string(val).value();
+  EXPECT_STREQ(str.c_str(), ".nan\n");
+  auto de_val = serde_yaml::from_str<double>(std::move(str)).value();
+  EXPECT_TRUE(std::isnan(de_val));
+}
+
 TEST(Builtin, Char)
 {
   char val = 'A';
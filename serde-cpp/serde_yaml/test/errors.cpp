@@ -4,3 +4,51 @@
 // 2. don't finish maps/seqs
 // 3. missing fields
 // 4. unexpected fields
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "serde/std.h"
+#include "serde/serde.h"
+#include "serde_yaml/serde_yaml.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Parse errors
+///////////////////////////////////////////////////////////////////////////////
+
+TEST(Errors, ParseUnclosedFlowSeq)
+{
+  auto res = serde_yaml::from_str<std::vector<int>>("[1, 2, 3");
+  ASSERT_FALSE(res.has_value());
+  EXPECT_EQ(res.error().kind, serde::Error::Kind::Syntax);
+  EXPECT_FALSE(res.error().text.empty());
+}
+
+TEST(Errors, ParseUnclosedFlowMap)
+{
+  auto res = serde_yaml::from_str<std::map<std::string, int>>("a: 1\nb: {c: 2\nd: 3\n");
+  ASSERT_FALSE(res.has_value());
+  EXPECT_EQ(res.error().kind, serde::Error::Kind::Syntax);
+}
+
+TEST(Errors, ParseErrorAt)
+{
+  auto res = serde_yaml::from_str_at<int>("a: [1, 2\n", "/a/0");
+  ASSERT_FALSE(res.has_value());
+  EXPECT_EQ(res.error().kind, serde::Error::Kind::Syntax);
+}
+
+TEST(Errors, ParseErrorInStream)
+{
+  std::istringstream input("--- [1]\n--- [2\n--- [3]\n");
+  std::vector<bool> ok;
+  for (auto& doc : serde_yaml::from_stream<std::vector<int>>(input))
+    ok.push_back(doc.has_value());
+  // a malformed document does not stop the ones after it
+  EXPECT_EQ(ok, std::vector<bool>({true, false, true}));
+  EXPECT_FALSE(serde_yaml::from_str_multi<std::vector<int>>("--- [1]\n--- [2\n--- [3]\n").has_value());
+}
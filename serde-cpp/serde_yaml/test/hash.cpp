@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "serde/std.h"
+#include "serde/serde.h"
+#include "serde/hash.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Content hashing
+///////////////////////////////////////////////////////////////////////////////
+
+TEST(Hash, Stable)
+{
+  // values are part of the contract, hashes are used as persistent cache keys
+  const std::map<std::string, std::vector<int>> map = {{"a", {1, 2}}};
+  EXPECT_EQ(serde::hash(map), 0xba5cb9c4311d6fe4ull);
+  EXPECT_EQ(serde::hash(std::string("hello")), 0x04a5261f223822d8ull);
+  EXPECT_EQ(serde::Hasher().digest64(), 0xe3f831695a72e52aull);
+}
+
+TEST(Hash, Content)
+{
+  using Type = std::map<std::string, std::vector<int>>;
+  const Type a = {{"x", {1, 2, 3}}, {"y", {}}};
+  Type b = a;
+  EXPECT_EQ(serde::hash(a), serde::hash(b));
+  EXPECT_EQ(serde::hash128(a), serde::hash128(b));
+  b["y"].push_back(0);
+  EXPECT_NE(serde::hash(a), serde::hash(b));
+  EXPECT_NE(serde::hash128(a), serde::hash128(b));
+
+  // structure and width are hashed, not only the scalars
+  EXPECT_NE(serde::hash(int32_t{1}), serde::hash(int64_t{1}));
+  EXPECT_NE(serde::hash(std::vector<std::string>{"ab", "c"}), serde::hash(std::vector<std::string>{"a", "bc"}));
+  EXPECT_NE(serde::hash(std::vector<std::vector<int>>{{1}, {}}), serde::hash(std::vector<std::vector<int>>{{}, {1}}));
+  EXPECT_NE(serde::hash(std::optional<int>{}), serde::hash(std::optional<int>{0}));
+  EXPECT_NE(serde::hash(std::optional<std::optional<int>>{}),
+            serde::hash(std::optional<std::optional<int>>{std::optional<int>{}}));
+  EXPECT_NE(serde::hash(std::pair<int, int>{1, 2}), serde::hash(std::tuple<int, int>{1, 2}));
+}
+
+TEST(Hash, Unordered)
+{
+  // same contents, different bucket counts and insertion orders
+  std::unordered_set<std::string> a(2), b(64);
+  std::unordered_map<int, std::vector<int>> c(2), d(64);
+  for (int i = 0; i < 40; i++) {
+    a.insert(std::to_string(i));
+    b.insert(std::to_string(39 - i));
+    c[i] = {i, i};
+    d[39 - i] = {39 - i, 39 - i};
+  }
+  EXPECT_EQ(serde::hash(a), serde::hash(b));
+  EXPECT_EQ(serde::hash128(c), serde::hash128(d));
+  EXPECT_EQ(serde::hash(std::vector<std::unordered_set<std::string>>{a, {}}),
+            serde::hash(std::vector<std::unordered_set<std::string>>{b, {}}));
+
+  // still a content hash: elements and their grouping count
+  b.insert("40");
+  EXPECT_NE(serde::hash(a), serde::hash(b));
+  d[0].push_back(0);
+  EXPECT_NE(serde::hash(c), serde::hash(d));
+  EXPECT_NE(serde::hash(std::unordered_map<int, int>{{1, 2}, {3, 4}}),
+            serde::hash(std::unordered_map<int, int>{{1, 4}, {3, 2}}));
+  EXPECT_NE(serde::hash(std::unordered_set<int>{1}), serde::hash(std::vector<int>{1}));
+}
+
+TEST(Hash, Streaming)
+{
+  std::mt19937 rng(11);
+  std::vector<uint8_t> data(5000);
+  for (auto& b : data) b = static_cast<uint8_t>(rng());
+  for (size_t len : {0, 1, 63, 64, 65, 1023, 1024, 1025, 4999}) {
+    serde::Hasher whole(serde::HashImpl::Scalar);
+    whole.update(data.data(), len);
+    serde::Hasher chunks;
+    for (size_t i = 0; i < len;) {
+      const size_t n = std::min<size_t>(len - i, rng() % 200);
+      chunks.update(data.data() + i, n);
+      i += n;
+    }
+    EXPECT_EQ(whole.digest64(), chunks.digest64()) << len;
+    EXPECT_EQ(whole.digest128(), chunks.digest128()) << len;
+  }
+  serde::Hasher empty;
+  empty.update(nullptr, 0);
+  EXPECT_EQ(empty.digest64(), serde::Hasher().digest64());
+}
+
+TEST(Hash, Implementations)
+{
+  if (serde::best_hash_impl() != serde::HashImpl::AVX2)
+    GTEST_SKIP() << "AVX2 not supported on this CPU";
+  std::vector<uint8_t> data(100000);
+  std::mt19937 rng(13);
+  for (auto& b : data) b = static_cast<uint8_t>(rng());
+  serde::Hasher scalar(serde::HashImpl::Scalar), avx2(serde::HashImpl::AVX2);
+  scalar.update(data.data(), data.size());
+  avx2.update(data.data(), data.size());
+  EXPECT_EQ(scalar.digest64(), avx2.digest64());
+  EXPECT_EQ(scalar.digest128(), avx2.digest128());
+}
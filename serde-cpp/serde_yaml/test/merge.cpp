@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "serde/std.h"
+#include "serde/serde.h"
+#include "serde_yaml/serde_yaml.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Partial updates
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+struct Limits {
+  int32_t cpu = 0;
+  int32_t memory = 0;
+};
+
+struct Service {
+  std::string name;
+  int32_t replicas = 0;
+  std::optional<std::string> image;
+  std::vector<std::string> args;
+  Limits limits;
+};
+
+struct Deployment {
+  std::vector<Service> services;
+  std::unique_ptr<Limits> quota;
+};
+} // namespace
+
+template<>
+void serde::deserialize(serde::Deserializer& de, Limits& val)
+{
+  de.deserialize_struct_begin();
+  de.deserialize_struct_field("cpu", val.cpu);
+  de.deserialize_struct_field("memory", val.memory);
+  de.deserialize_struct_end();
+}
+
+template<>
+void serde::deserialize(serde::Deserializer& de, Service& val)
+{
+  de.deserialize_struct_begin();
+  de.deserialize_struct_field("name", val.name);
+  de.deserialize_struct_field("replicas", val.replicas);
+  de.deserialize_struct_field("image", val.image);
+  de.deserialize_struct_field("args", val.args);
+  de.deserialize_struct_field("limits", val.limits);
+  de.deserialize_struct_end();
+}
+
+template<>
+void serde::deserialize(serde::Deserializer& de, Deployment& val)
+{
+  de.deserialize_struct_begin();
+  de.deserialize_struct_field("services", val.services);
+  de.deserialize_struct_field("quota", val.quota);
+  de.deserialize_struct_end();
+}
+
+static Service base()
+{
+  return {"api", 3, "api:1.0", {"--port", "80", "--verbose"}, {2, 512}};
+}
+
+TEST(Merge, Fields)
+{
+  Service svc = base();
+  ASSERT_TRUE(serde_yaml::from_str_into(svc, "replicas: 5\nlimits:\n  memory: 1024\n"));
+  EXPECT_EQ(svc.name, "api");
+  EXPECT_EQ(svc.replicas, 5);
+  EXPECT_EQ(svc.image, "api:1.0");
+  EXPECT_EQ(svc.args, (std::vector<std::string>{"--port", "80", "--verbose"}));
+  EXPECT_EQ(svc.limits.cpu, 2);
+  EXPECT_EQ(svc.limits.memory, 1024);
+
+  // present fields are replaced, null clears an optional
+  ASSERT_TRUE(serde_yaml::from_str_into(svc, "image: null\nargs: [--port, '8080']\n"));
+  EXPECT_FALSE(svc.image);
+  EXPECT_EQ(svc.args, (std::vector<std::string>{"--port", "8080"}));
+  EXPECT_EQ(svc.replicas, 5);
+
+  // nothing to update
+  ASSERT_TRUE(serde_yaml::from_str_into(svc, "{}"));
+  EXPECT_EQ(svc.name, "api");
+  EXPECT_EQ(svc.limits.memory, 1024);
+}
+
+TEST(Merge, Capacity)
+{
+  Service svc = base();
+  const auto* args = svc.args.data();
+  const auto capacity = svc.args.capacity();
+  ASSERT_TRUE(serde_yaml::from_str_into(svc, "args: [a, b]\n"));
+  EXPECT_EQ(svc.args, (std::vector<std::string>{"a", "b"}));
+  EXPECT_EQ(svc.args.data(), args);
+  EXPECT_EQ(svc.args.capacity(), capacity);
+}
+
+TEST(Merge, ReplacedElements)
+{
+  Deployment dep;
+  dep.services = {base(), base()};
+  dep.quota = std::make_unique<Limits>(Limits{8, 4096});
+
+  // elements and pointees present in the input are replaced, not merged
+  ASSERT_TRUE(serde_yaml::from_str_into(dep, "services:\n- name: web\nquota: {cpu: 4}\n"));
+  ASSERT_EQ(dep.services.size(), 1u);
+  EXPECT_EQ(dep.services[0].name, "web");
+  EXPECT_EQ(dep.services[0].replicas, 0);
+  EXPECT_FALSE(dep.services[0].image);
+  EXPECT_TRUE(dep.services[0].args.empty());
+  EXPECT_EQ(dep.services[0].limits.cpu, 0);
+  ASSERT_TRUE(dep.quota);
+  EXPECT_EQ(dep.quota->cpu, 4);
+  EXPECT_EQ(dep.quota->memory, 0);
+
+  // absent, they are kept
+  ASSERT_TRUE(serde_yaml::from_str_into(dep, "quota: {memory: 1}\n"));
+  ASSERT_EQ(dep.services.size(), 1u);
+  EXPECT_EQ(dep.services[0].name, "web");
+  EXPECT_EQ(dep.quota->cpu, 0);
+  EXPECT_EQ(dep.quota->memory, 1);
+}
+
+TEST(Merge, Errors)
+{
+  Service svc = base();
+  auto res = serde_yaml::from_str_into(svc, "replicas: [1\n");
+  ASSERT_FALSE(res);
+  EXPECT_EQ(res.error().kind, serde::Error::Kind::Syntax);
+  EXPECT_EQ(svc.replicas, 3);
+}
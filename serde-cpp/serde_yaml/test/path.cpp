@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "serde/std.h"
+#include "serde/serde.h"
+#include "serde_yaml/serde_yaml.h"
+
+static const char* const config = R"(# services
+defaults:
+  retries: 3
+services:
+  api:
+    port: 8080
+    hosts:
+      - a.example
+      - b.example
+  "a/b~c":
+    port: 9090
+ports:
+- 1
+- 2
+- 3
+)";
+
+///////////////////////////////////////////////////////////////////////////////
+// Path
+///////////////////////////////////////////////////////////////////////////////
+
+TEST(Path, Root)
+{
+  auto value = serde_yaml::from_str_at<std::map<std::string, int>>("a: 1\nb: 2\n", "").value();
+  EXPECT_EQ(value, (std::map<std::string, int>{{"a", 1}, {"b", 2}}));
+}
+
+TEST(Path, Nested)
+{
+  EXPECT_EQ(serde_yaml::from_str_at<int>(config, "/services/api/port").value(), 8080);
+  EXPECT_EQ(serde_yaml::from_str_at<std::string>(config, "/services/api/hosts/1").value(), "b.example");
+  EXPECT_EQ(serde_yaml::from_str_at<std::vector<int>>(config, "/ports").value(), std::vector<int>({1, 2, 3}));
+  auto defaults = serde_yaml::from_str_at<std::map<std::string, int>>(config, "/defaults").value();
+  EXPECT_EQ(defaults, (std::map<std::string, int>{{"retries", 3}}));
+}
+
+TEST(Path, Escapes)
+{
+  EXPECT_EQ(serde_yaml::from_str_at<int>(config, "/services/a~1b~0c/port").value(), 9090);
+}
+
+TEST(Path, NotFound)
+{
+  EXPECT_FALSE(serde_yaml::from_str_at<int>(config, "/services/web/port").has_value());
+  EXPECT_FALSE(serde_yaml::from_str_at<int>(config, "/ports/3").has_value());
+  EXPECT_FALSE(serde_yaml::from_str_at<int>(config, "/ports/x").has_value());
+  EXPECT_FALSE(serde_yaml::from_str_at<int>(config, "/defaults/retries/0").has_value());
+  EXPECT_FALSE(serde_yaml::from_str_at<int>(config, "ports").has_value());
+}
+
+TEST(Path, Lazy)
+{
+  EXPECT_EQ(serde_yaml::from_str_at_lazy<int>(config, "/services/api/port").value(), 8080);
+  EXPECT_EQ(serde_yaml::from_str_at_lazy<std::vector<int>>(config, "/ports").value(), std::vector<int>({1, 2, 3}));
+  EXPECT_EQ(serde_yaml::from_str_at_lazy<int>(config, "/defaults/retries").value(), 3);
+  EXPECT_FALSE(serde_yaml::from_str_at_lazy<int>(config, "/missing").has_value());
+}
+
+TEST(Path, Section)
+{
+  using serde_yaml::detail::PathSection;
+  EXPECT_EQ(PathSection(config, "/defaults"), "defaults:\n  retries: 3\n");
+  EXPECT_EQ(PathSection(config, "/ports/0"), "ports:\n- 1\n- 2\n- 3\n");
+  EXPECT_EQ(PathSection("---\na: 1\nb: 2\n...\n", "/a"), "a: 1\n");
+  // not told apart from the text, the whole input is parsed
+  EXPECT_EQ(PathSection(config, ""), config);
+  EXPECT_EQ(PathSection("{a: 1, b: 2}", "/a"), "{a: 1, b: 2}");
+  EXPECT_EQ(PathSection("a: &x 1\nb: *x\n", "/b"), "a: &x 1\nb: *x\n");
+  EXPECT_EQ(PathSection("a: 1\n---\nb: 2\n", "/b"), "a: 1\n---\nb: 2\n");
+  EXPECT_EQ(PathSection("--- !!map\na: 1\n", "/a"), "--- !!map\na: 1\n");
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "serde/std.h"
+#include "serde/serde.h"
+#include "serde/profile.h"
+#include "serde_yaml/serde_yaml.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Profiling (de)serializers
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+struct Record {
+  int32_t id;
+  std::string name;
+  std::vector<double> values;
+};
+} // namespace
+
+template<>
+void serde::serialize(serde::Serializer& ser, const Record& rec)
+{
+  ser.serialize_struct_begin();
+  ser.serialize_struct_field("id", rec.id);
+  ser.serialize_struct_field("name", rec.name);
+  ser.serialize_struct_field("values", rec.values);
+  ser.serialize_struct_end();
+}
+
+template<>
+void serde::deserialize(serde::Deserializer& de, Record& rec)
+{
+  de.deserialize_struct_begin();
+  de.deserialize_struct_field("id", rec.id);
+  de.deserialize_struct_field("name", rec.name);
+  de.deserialize_struct_field("values", rec.values);
+  de.deserialize_struct_end();
+}
+
+TEST(Profile, Serializer)
+{
+  const std::vector<Record> recs = {{1, "one", {1.0, 2.0}}, {2, "two", {}}};
+  serde::Profile profile;
+  auto ser = serde_yaml::detail::SerializerNew();
+  serde::ProfilingSerializer prof(*ser, profile);
+  prof.serialize(recs);
+  auto str = serde_yaml::detail::SerializerOutput(ser.get()).value();
+  EXPECT_EQ(str, serde_yaml::to_string(recs).value());
+
+  auto& methods = profile.methods();
+  EXPECT_EQ(methods.at("serialize_i32").calls, 2u);
+  EXPECT_EQ(methods.at("serialize_i32").bytes, 8u);
+  EXPECT_EQ(methods.at("serialize_double").calls, 2u);
+  EXPECT_EQ(methods.at("serialize_struct_begin").calls, 2u);
+  auto& fields = profile.fields();
+  EXPECT_EQ(fields.at("id").calls, 2u);
+  EXPECT_EQ(fields.at("name").bytes, 6u);
+  EXPECT_EQ(fields.at("values").bytes, 16u);
+  EXPECT_GE(fields.at("values").time, methods.at("serialize_double").time / 2);
+}
+
+TEST(Profile, Deserializer)
+{
+  const std::vector<Record> recs = {{1, "one", {1.0, 2.0}}, {2, "two", {}}};
+  serde::Profile profile;
+  auto de = serde_yaml::detail::DeserializerNew(serde_yaml::to_string(recs).value());
+  ASSERT_TRUE(serde_yaml::detail::DeserializerParse(de.get()));
+  serde::ProfilingDeserializer prof(*de, profile);
+  std::vector<Record> out;
+  prof.deserialize(out);
+  ASSERT_EQ(out.size(), 2u);
+  EXPECT_EQ(out[1].name, "two");
+  EXPECT_EQ(out[0].values, recs[0].values);
+
+  EXPECT_EQ(profile.methods().at("deserialize_i32").calls, 2u);
+  EXPECT_EQ(profile.fields().at("values").calls, 2u);
+  EXPECT_EQ(profile.fields().at("values").bytes, 16u);
+}
+
+TEST(Profile, MergeReportSample)
+{
+  serde::Profile a, b;
+  a.record_method("serialize_i32", 4, std::chrono::microseconds(3));
+  b.record_method("serialize_i32", 4, std::chrono::microseconds(1));
+  b.record_field("slow", 100, std::chrono::microseconds(50));
+  b.record_field("fast", 1, std::chrono::microseconds(1));
+  a.merge(b);
+  EXPECT_EQ(a.methods().at("serialize_i32").calls, 2u);
+  EXPECT_EQ(a.methods().at("serialize_i32").time, std::chrono::microseconds(4));
+
+  std::ostringstream os;
+  a.report(os);
+  const auto report = os.str();
+  EXPECT_NE(report.find("serialize_i32\t2\t8\t4000\n"), std::string::npos);
+  EXPECT_LT(report.find("slow"), report.find("fast"));
+
+  size_t sampled = 0;
+  for (int i = 0; i < 1000; i++) sampled += a.sample(100);
+  EXPECT_EQ(sampled, 10u);
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include "serde/std.h"
+#include "serde/serde.h"
+#include "serde/ser/size.h"
+#include "serde_yaml/serde_yaml.h"
+#include "serde_yaml/size_yaml.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Size models
+///////////////////////////////////////////////////////////////////////////////
+
+TEST(Size, Fixed_Scalars)
+{
+  using Model = serde::size::Fixed;
+  EXPECT_EQ(serde::serialized_size<Model>(true), 1u);
+  EXPECT_EQ(serde::serialized_size<Model>(int16_t{-3}), 2u);
+  EXPECT_EQ(serde::serialized_size<Model>(42), 4u);
+  EXPECT_EQ(serde::serialized_size<Model>(3.14), 8u);
+  EXPECT_EQ(serde::serialized_size<Model>("hello"), 8u + 5u);
+}
+
+TEST(Size, Varint_Scalars)
+{
+  using Model = serde::size::Varint;
+  EXPECT_EQ(serde::serialized_size<Model>(0), 1u);
+  EXPECT_EQ(serde::serialized_size<Model>(-64), 1u);
+  EXPECT_EQ(serde::serialized_size<Model>(-65), 2u);
+  EXPECT_EQ(serde::serialized_size<Model>(uint64_t{~0ull}), 10u);
+  EXPECT_EQ(serde::serialized_size<Model>(3.14f), 4u);
+}
+
+TEST(Size, Fixed_Containers)
+{
+  using Model = serde::size::Fixed;
+  const std::vector<int> vec = {1, 2, 3};
+  EXPECT_EQ(serde::serialized_size<Model>(vec), 8u + 3 * 4u);
+  const std::map<std::string, int> map = {{"a", 1}, {"bc", 2}};
+  EXPECT_EQ(serde::serialized_size<Model>(map), 8u + (8u + 1 + 4) + (8u + 2 + 4));
+  const std::vector<std::string> strs = {"x", ""};
+  EXPECT_EQ(serde::serialized_size<Model>(strs), 8u + (8u + 1) + 8u);
+}
+
+TEST(Size, Fixed_Optional)
+{
+  using Model = serde::size::Fixed;
+  std::optional<int> opt;
+  EXPECT_EQ(serde::serialized_size<Model>(opt), 1u);
+  opt = 5;
+  EXPECT_EQ(serde::serialized_size<Model>(opt), 1u + 4u);
+  const auto ptr = std::make_unique<double>(1.0);
+  EXPECT_EQ(serde::serialized_size<Model>(ptr), 1u + 8u);
+}
+
+TEST(Size, Optional_PresenceTag)
+{
+  // the presence tag is charged whether or not the value is there
+  using Fixed = serde::size::Fixed;
+  using Varint = serde::size::Varint;
+  const std::optional<int> some = 5, none;
+  EXPECT_EQ(serde::serialized_size<Fixed>(some), serde::serialized_size<Fixed>(none) + serde::serialized_size<Fixed>(5));
+  EXPECT_EQ(serde::serialized_size<Varint>(some), serde::serialized_size<Varint>(none) + serde::serialized_size<Varint>(5));
+  const std::unique_ptr<int> ptr = std::make_unique<int>(5), null;
+  EXPECT_EQ(serde::serialized_size<Fixed>(ptr), serde::serialized_size<Fixed>(some));
+  EXPECT_EQ(serde::serialized_size<Fixed>(null), serde::serialized_size<Fixed>(none));
+}
+
+TEST(Size, Fixed_Composite)
+{
+  using Model = serde::size::Fixed;
+  const std::pair<int, std::string> pair = {1, "ab"};
+  EXPECT_EQ(serde::serialized_size<Model>(pair), 4u + 8u + 2u);
+  const std::tuple<char, int> tuple = {'a', 2};
+  EXPECT_EQ(serde::serialized_size<Model>(tuple), 8u + 1u + 4u);
+  const std::variant<char, int> variant = 2;
+  EXPECT_EQ(serde::serialized_size<Model>(variant), 8u + sizeof(size_t) + 4u);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Size-only serializer
+///////////////////////////////////////////////////////////////////////////////
+
+template<typename Model, typename T>
+static size_t dry_run_size(const T& val)
+{
+  serde::SizeSerializer<Model> ser;
+  ser.serialize(val);
+  return ser.size();
+}
+
+TEST(Size, SizeSerializer_SameAsSerializedSize)
+{
+  using Fixed = serde::size::Fixed;
+  using Varint = serde::size::Varint;
+  const std::map<std::string, std::vector<int64_t>> map = {{"a", {1, -200, 300000}}, {"bc", {}}};
+  EXPECT_EQ(dry_run_size<Fixed>(map), serde::serialized_size<Fixed>(map));
+  EXPECT_EQ(dry_run_size<Varint>(map), serde::serialized_size<Varint>(map));
+  const std::vector<std::optional<std::pair<int, std::string>>> opts = {std::nullopt, {{7, "seven"}}};
+  EXPECT_EQ(dry_run_size<Fixed>(opts), serde::serialized_size<Fixed>(opts));
+  EXPECT_EQ(dry_run_size<Varint>(opts), serde::serialized_size<Varint>(opts));
+  const auto ptr = std::make_unique<std::string>("present");
+  EXPECT_EQ(dry_run_size<Fixed>(ptr), serde::serialized_size<Fixed>(ptr));
+  const std::tuple<char, std::vector<std::vector<uint32_t>>> nested = {'x', {{1, 2}, {}, {1u << 20}}};
+  EXPECT_EQ(dry_run_size<Fixed>(nested), serde::serialized_size<Fixed>(nested));
+  EXPECT_EQ(dry_run_size<Varint>(nested), serde::serialized_size<Varint>(nested));
+  const std::variant<double, std::string> variant = std::string(200, 'v');
+  EXPECT_EQ(dry_run_size<Varint>(variant), serde::serialized_size<Varint>(variant));
+}
+
+TEST(Size, SizeSerializer_Reset)
+{
+  serde::SizeSerializer<serde::size::Fixed> ser;
+  ser.serialize(std::vector<int>{1, 2});
+  EXPECT_EQ(ser.size(), 8u + 2 * 4u);
+  ser.reset();
+  ser.serialize(int16_t{1});
+  EXPECT_EQ(ser.size(), 2u);
+}
+
+TEST(Size, Yaml_Estimate)
+{
+  const std::map<std::string, std::vector<int>> map = {{"alpha", {1, -20, 300}}, {"beta", {}}};
+  const auto yaml = serde_yaml::to_string(map).value();
+  // only indentation is missing from the estimate of this document
+  const auto estimate = serde_yaml::estimated_size(map);
+  EXPECT_LE(estimate, yaml.size());
+  EXPECT_GE(estimate + 3 * 2, yaml.size());
+
+  const std::vector<std::string> flat = {"one", "two", "three"};
+  EXPECT_EQ(serde_yaml::estimated_size(flat), serde_yaml::to_string(flat).value().size());
+  EXPECT_EQ(serde_yaml::SizeModel::scalar(-1234), 5u);
+  EXPECT_EQ(serde_yaml::SizeModel::scalar(uint64_t{0}), 1u);
+  EXPECT_EQ(serde_yaml::SizeModel::scalar(0.5), 3u);
+}
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 
+#include <memory_resource>
+
 #include "serde/std.h"
 #include "serde/serde.h"
 #include "serde_yaml/serde_yaml.h"
@@ -102,6 +104,35 @@ TEST(Std, SharedPtr_Empty)
   EXPECT_EQ(de_val, val);
 }
 
+TEST(Std, SharedPtr_Alias)
+{
+  using Type = std::vector<std::shared_ptr<std::string>>;
+  auto shared = std::make_shared<std::string>("Bananas");
+  const Type val = { shared, std::make_shared<std::string>("Apples"), shared, shared };
+  auto str = serde_yaml::to_string(val).value();
+  EXPECT_STREQ(str.c_str(), "- &id1 Bananas\n- Apples\n- *id1\n- *id1\n");
+  auto de_val = serde_yaml::from_str<Type>(std::move(str)).value();
+  ASSERT_EQ(de_val.size(), val.size());
+  EXPECT_EQ(*de_val[0], "Bananas");
+  EXPECT_EQ(*de_val[1], "Apples");
+  EXPECT_EQ(de_val[2], de_val[0]);
+  EXPECT_EQ(de_val[3], de_val[0]);
+}
+
+TEST(Std, SharedPtr_AliasContainer)
+{
+  using Type = std::map<std::string, std::shared_ptr<std::vector<int>>>;
+  auto shared = std::make_shared<std::vector<int>>(std::vector<int>{1, 2, 3});
+  const Type val = { {"a", shared}, {"b", shared}, {"c", std::make_shared<std::vector<int>>()} };
+  auto str = serde_yaml::to_string(val).value();
+  EXPECT_NE(str.find("*id1"), std::string::npos);
+  auto de_val = serde_yaml::from_str<Type>(std::move(str)).value();
+  ASSERT_EQ(de_val.size(), val.size());
+  EXPECT_EQ(*de_val["a"], *shared);
+  EXPECT_EQ(de_val["b"], de_val["a"]);
+  EXPECT_NE(de_val["c"], de_val["a"]);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // std::optional
 ///////////////////////////////////////////////////////////////////////////////
@@ -174,6 +205,25 @@ TEST(Std, Vector_Empty)
   EXPECT_EQ(de_val, val);
 }
 
+TEST(Std, Vector_Maps)
+{
+  using Type = std::vector<std::pair<int, int>>;
+  const Type val = {{1, 2}, {3, 4}, {5, 6}};
+  auto str = serde_yaml::to_string(val).value();
+  EXPECT_STREQ(str.c_str(), "- first: 1\n  second: 2\n- first: 3\n  second: 4\n- first: 5\n  second: 6\n");
+  auto de_val = serde_yaml::from_str<Type>(std::move(str)).value();
+  EXPECT_EQ(de_val, val);
+}
+
+TEST(Std, Vector_Seqs)
+{
+  using Type = std::vector<std::vector<int>>;
+  const Type val = {{1, 2}, {3}, {4, 5, 6}};
+  auto str = serde_yaml::to_string(val).value();
+  auto de_val = serde_yaml::from_str<Type>(std::move(str)).value();
+  EXPECT_EQ(de_val, val);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // std::variant
 ///////////////////////////////////////////////////////////////////////////////
@@ -573,3 +623,64 @@ TEST(Std, Stack_Empty)
   EXPECT_EQ(de_val, val);
 }
 
+
+///////////////////////////////////////////////////////////////////////////////
+// std::pmr
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+// Allocator-aware struct, passes its allocator on to its members
+struct PmrRecord {
+  using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+  std::pmr::string name;
+  std::pmr::vector<std::pmr::string> tags;
+
+  PmrRecord() = default;
+  explicit PmrRecord(const allocator_type& alloc) : name(alloc), tags(alloc) {}
+  PmrRecord(const PmrRecord& other, const allocator_type& alloc) : name(other.name, alloc), tags(other.tags, alloc) {}
+};
+} // namespace
+
+template<>
+void serde::deserialize(serde::Deserializer& de, PmrRecord& val)
+{
+  de.deserialize_struct_begin();
+  de.deserialize_struct_field("name", val.name);
+  de.deserialize_struct_field("tags", val.tags);
+  de.deserialize_struct_end();
+}
+
+TEST(Std, Pmr_ObjectResource)
+{
+  using Type = std::pmr::map<std::pmr::string, std::pmr::vector<std::pmr::string>>;
+  std::pmr::monotonic_buffer_resource arena;
+  serde_yaml::ParseOptions options;
+  options.object_resource = &arena;
+  auto val = serde_yaml::from_str<Type>(
+      "first key, long enough to allocate:\n  - first value, long enough to allocate\n"
+      "second key, long enough to allocate:\n  - second value, long enough to allocate\n",
+      options).value();
+  ASSERT_EQ(val.size(), 2u);
+  EXPECT_EQ(val.get_allocator().resource(), &arena);
+  for (const auto& [key, values] : val) {
+    EXPECT_EQ(key.get_allocator().resource(), &arena);
+    ASSERT_EQ(values.size(), 1u);
+    EXPECT_EQ(values[0].get_allocator().resource(), &arena);
+  }
+  EXPECT_EQ(val.begin()->second[0], "first value, long enough to allocate");
+
+  // structs get the resource when allocator-aware, as elements and as the root
+  auto records = serde_yaml::from_str<std::pmr::vector<PmrRecord>>(
+      "- name: first name, long enough to allocate\n  tags: [first tag, long enough to allocate]\n"
+      "- name: second name, long enough to allocate\n  tags: []\n",
+      options).value();
+  ASSERT_EQ(records.size(), 2u);
+  EXPECT_EQ(records.get_allocator().resource(), &arena);
+  for (const auto& record : records) {
+    EXPECT_EQ(record.name.get_allocator().resource(), &arena);
+    EXPECT_EQ(record.tags.get_allocator().resource(), &arena);
+  }
+  ASSERT_EQ(records[0].tags.size(), 1u);
+  EXPECT_EQ(records[0].tags[0].get_allocator().resource(), &arena);
+  EXPECT_EQ(records[1].name, "second name, long enough to allocate");
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stdexcept>
+
+#include "serde/std.h"
+#include "serde/serde.h"
+#include "serde_yaml/serde_yaml.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Document splitting
+///////////////////////////////////////////////////////////////////////////////
+
+static std::vector<std::string> split(const std::string& yaml)
+{
+  std::istringstream input(yaml);
+  serde_yaml::DocumentSplitter splitter(input);
+  std::vector<std::string> documents;
+  std::string document;
+  while (splitter.next(document))
+    documents.push_back(document);
+  return documents;
+}
+
+TEST(Stream, SplitSingleDocument)
+{
+  EXPECT_EQ(split("a: 1\nb: 2"), std::vector<std::string>({"a: 1\nb: 2\n"}));
+}
+
+TEST(Stream, SplitMarkers)
+{
+  const auto documents = split("# header\n---\na: 1\n---\nb: 2\n...\n# trailer\n--- [1, 2]\n---\n");
+  EXPECT_EQ(documents, std::vector<std::string>({"a: 1\n", "b: 2\n", "[1, 2]\n"}));
+}
+
+TEST(Stream, SplitIgnoresIndentedAndLongerMarkers)
+{
+  const auto documents = split("a: |\n  ---\n----: 1\n");
+  EXPECT_EQ(documents, std::vector<std::string>({"a: |\n  ---\n----: 1\n"}));
+}
+
+TEST(Stream, SplitEmpty)
+{
+  EXPECT_TRUE(split("").empty());
+  EXPECT_TRUE(split("---\n# nothing\n...\n---\n").empty());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Document stream
+///////////////////////////////////////////////////////////////////////////////
+
+TEST(Stream, DeserializeDocuments)
+{
+  using Type = std::map<std::string, int>;
+  std::istringstream input("---\na: 1\n---\nb: 2\nc: 3\n---\nd: 4\n");
+  std::vector<Type> values;
+  for (auto& value : serde_yaml::from_stream<Type>(input))
+    values.push_back(value.value());
+  EXPECT_EQ(values, std::vector<Type>({{{"a", 1}}, {{"b", 2}, {"c", 3}}, {{"d", 4}}}));
+}
+
+TEST(Stream, DeserializeManyDocuments)
+{
+  std::stringstream input;
+  for (int i = 0; i < 1000; i++)
+    input << "--- [" << i << ", " << i * 2 << "]\n";
+  auto stream = serde_yaml::from_stream<std::vector<int>>(input);
+  int i = 0;
+  while (auto value = stream.next()) {
+    EXPECT_EQ(value->value(), std::vector<int>({i, i * 2}));
+    i++;
+  }
+  EXPECT_EQ(i, 1000);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Parallel multi-document
+///////////////////////////////////////////////////////////////////////////////
+
+TEST(Stream, SplitDocumentsInMemory)
+{
+  const std::string yaml = "# header\n---\na: 1\n---\nb: 2\n...\n# trailer\n--- [1, 2]\n---\n";
+  const auto views = serde_yaml::split_documents(yaml);
+  std::vector<std::string> documents(views.begin(), views.end());
+  EXPECT_EQ(documents, std::vector<std::string>({"a: 1\n", "b: 2\n", "[1, 2]\n"}));
+  EXPECT_EQ(documents, split(yaml));
+}
+
+TEST(Stream, FromStrMulti)
+{
+  std::string yaml;
+  for (int i = 0; i < 1000; i++)
+    yaml += "---\n- " + std::to_string(i) + "\n- " + std::to_string(i * 3) + "\n";
+  for (unsigned threads : {0u, 1u, 4u}) {
+    auto values = serde_yaml::from_str_multi<std::vector<int>>(yaml, threads).value();
+    ASSERT_EQ(values.size(), 1000u);
+    for (int i = 0; i < 1000; i++)
+      EXPECT_EQ(values[i], std::vector<int>({i, i * 3}));
+  }
+}
+
+TEST(Stream, FromStrMultiEmpty)
+{
+  EXPECT_TRUE(serde_yaml::from_str_multi<int>("").value().empty());
+}
+
+struct Positive {
+  int value = 0;
+  void deserialize(serde::Deserializer& de) {
+    de.deserialize_i32(value);
+    if (value < 0)
+      throw std::invalid_argument("negative");
+  }
+};
+
+TEST(Stream, FromStrMultiException)
+{
+  auto values = serde_yaml::from_str_multi<Positive>("--- 1\n--- -2\n--- 3\n", 2);
+  ASSERT_FALSE(values.has_value());
+  EXPECT_EQ(values.error().text, "negative");
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+
+#include "serde/std.h"
+#include "serde/serde.h"
+#include "serde/tape.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Tape clone and convert
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+struct Settings {
+  int32_t retries = 0;
+  std::string name;
+  std::vector<double> weights;
+};
+
+// same fields as Settings in another order, with one less and one more
+struct SettingsView {
+  std::string name;
+  int64_t retries = 0;
+  std::optional<std::string> comment;
+};
+} // namespace
+
+template<>
+void serde::serialize(serde::Serializer& ser, const Settings& val)
+{
+  ser.serialize_struct_begin();
+  ser.serialize_struct_field("retries", val.retries);
+  ser.serialize_struct_field("name", val.name);
+  ser.serialize_struct_field("weights", val.weights);
+  ser.serialize_struct_end();
+}
+
+template<>
+void serde::deserialize(serde::Deserializer& de, Settings& val)
+{
+  de.deserialize_struct_begin();
+  de.deserialize_struct_field("retries", val.retries);
+  de.deserialize_struct_field("name", val.name);
+  de.deserialize_struct_field("weights", val.weights);
+  de.deserialize_struct_end();
+}
+
+template<>
+void serde::deserialize(serde::Deserializer& de, SettingsView& val)
+{
+  de.deserialize_struct_begin();
+  de.deserialize_struct_field("name", val.name);
+  de.deserialize_struct_field("comment", val.comment);
+  de.deserialize_struct_field("retries", val.retries);
+  de.deserialize_struct_end();
+}
+
+TEST(Tape, Clone)
+{
+  using Type = std::map<std::string, std::vector<std::optional<std::variant<int, std::string>>>>;
+  const Type val = {{"a", {1, std::nullopt, std::string("two")}}, {"b", {}}, {"c", {std::nullopt}}};
+  EXPECT_EQ(serde::clone(val), val);
+
+  const std::tuple<char, float, std::set<uint64_t>, std::pair<bool, std::string>> tuple =
+      {'x', 0.25f, {1, ~0ull}, {true, std::string(100, 'y')}};
+  EXPECT_EQ(serde::clone(tuple), tuple);
+
+  const std::vector<Settings> settings = {{3, "first", {0.5, 1.5}}, {-1, "", {}}};
+  const auto copy = serde::clone(settings);
+  ASSERT_EQ(copy.size(), 2u);
+  EXPECT_EQ(copy[0].retries, 3);
+  EXPECT_EQ(copy[0].name, "first");
+  EXPECT_EQ(copy[0].weights, settings[0].weights);
+  EXPECT_EQ(copy[1].retries, -1);
+}
+
+TEST(Tape, CloneNestedOptional)
+{
+  using Inner = std::optional<int>;
+  const std::optional<Inner> some_none = Inner{};
+  EXPECT_EQ(serde::clone(some_none), some_none);
+  EXPECT_EQ(serde::clone(std::optional<Inner>{}), std::nullopt);
+
+  const std::vector<std::optional<Inner>> vec = {Inner{}, std::nullopt, Inner{4}, Inner{}};
+  EXPECT_EQ(serde::clone(vec), vec);
+  const std::map<std::string, std::optional<Inner>> map = {{"a", Inner{}}, {"b", std::nullopt}, {"c", Inner{5}}};
+  EXPECT_EQ(serde::clone(map), map);
+
+  // read as plain values, the presence of optionals is passed through
+  EXPECT_EQ(serde::convert<std::vector<int>>(std::vector<std::optional<int>>{1, 2}).value(), std::vector<int>({1, 2}));
+}
+
+TEST(Tape, CloneShared)
+{
+  auto shared = std::make_shared<std::string>("shared");
+  const std::vector<std::shared_ptr<std::string>> val = {shared, nullptr, shared};
+  const auto copy = serde::clone(val);
+  ASSERT_EQ(copy.size(), 3u);
+  ASSERT_TRUE(copy[0]);
+  EXPECT_EQ(*copy[0], "shared");
+  EXPECT_NE(copy[0], shared);
+  EXPECT_FALSE(copy[1]);
+  EXPECT_EQ(copy[0], copy[2]);
+
+  // read as unique objects, the reference is copied
+  const auto unique = serde::convert<std::vector<std::optional<std::string>>>(val).value();
+  ASSERT_EQ(unique.size(), 3u);
+  EXPECT_EQ(unique[2], "shared");
+  EXPECT_FALSE(unique[1]);
+}
+
+TEST(Tape, Convert)
+{
+  EXPECT_EQ(serde::convert<std::vector<int64_t>>(std::vector<int16_t>{-1, 2}).value(), (std::vector<int64_t>{-1, 2}));
+  EXPECT_EQ(serde::convert<std::vector<double>>(std::list<int>{1, 2}).value(), (std::vector<double>{1.0, 2.0}));
+
+  const Settings settings{7, "seven", {1.0}};
+  const auto view = serde::convert<SettingsView>(settings).value();
+  EXPECT_EQ(view.name, "seven");
+  EXPECT_EQ(view.retries, 7);
+  EXPECT_FALSE(view.comment);
+
+  const auto map = serde::convert<std::map<std::string, std::variant<int32_t, std::string, std::vector<double>>>>(settings);
+  // variants are maps of index to value, a struct's fields are not
+  EXPECT_TRUE(map.has_error());
+}
+
+TEST(Tape, ConvertErrors)
+{
+  auto narrow = serde::convert<std::vector<uint8_t>>(std::vector<int>{1, 300});
+  ASSERT_TRUE(narrow.has_error());
+  EXPECT_EQ(narrow.error().kind, serde::Error::Kind::Invalid);
+  EXPECT_NE(narrow.error().text.find("out of range"), std::string::npos);
+
+  EXPECT_TRUE(serde::convert<std::vector<uint32_t>>(std::vector<int>{-1}).has_error());
+  EXPECT_TRUE(serde::convert<float>(1e300).has_error());
+  EXPECT_EQ(serde::convert<float>(-2.5).value(), -2.5f);
+  EXPECT_TRUE(std::isinf(serde::convert<float>(std::numeric_limits<double>::infinity()).value()));
+  EXPECT_TRUE(serde::convert<std::string>(42).has_error());
+  EXPECT_TRUE((serde::convert<std::map<int, int>>(std::vector<int>{1}).has_error()));
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "serde/std.h"
+#include "serde/serde.h"
+#include "serde/tape.h"
+#include "serde_yaml/serde_yaml.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// YAML transcoding
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+struct Host {
+  std::string name;
+  int64_t port = 0;
+  double load = 0;
+  bool enabled = false;
+  std::optional<std::string> owner;
+  std::vector<std::string> tags;
+};
+
+// Reads what a Serializer was given back into T
+template<typename T>
+auto read_tape(const serde::Tape& tape) -> T
+{
+  serde::TapeDeserializer de(tape);
+  T val = serde::make_default<T>(de);
+  de.deserialize(val);
+  EXPECT_FALSE(de.error()) << de.error()->text;
+  return val;
+}
+} // namespace
+
+template<>
+void serde::deserialize(serde::Deserializer& de, Host& val)
+{
+  de.deserialize_struct_begin();
+  de.deserialize_struct_field("name", val.name);
+  de.deserialize_struct_field("port", val.port);
+  de.deserialize_struct_field("load", val.load);
+  de.deserialize_struct_field("enabled", val.enabled);
+  de.deserialize_struct_field("owner", val.owner);
+  de.deserialize_struct_field("tags", val.tags);
+  de.deserialize_struct_end();
+}
+
+TEST(Transcode, Scalars)
+{
+  serde::Tape tape;
+  serde::TapeSerializer ser(tape);
+  ASSERT_TRUE(serde_yaml::transcode("name: web\nport: 8080\nload: 0.25\nenabled: true\n"
+                                    "owner: ~\ntags: [a, '1', !!str 2, 3x]\n", ser));
+  const auto host = read_tape<Host>(tape);
+  EXPECT_EQ(host.name, "web");
+  EXPECT_EQ(host.port, 8080);
+  EXPECT_EQ(host.load, 0.25);
+  EXPECT_TRUE(host.enabled);
+  EXPECT_FALSE(host.owner);
+  EXPECT_EQ(host.tags, (std::vector<std::string>{"a", "1", "2", "3x"}));
+
+  // types follow the text, so quoted numbers are strings and large ones unsigned
+  tape.clear();
+  ASSERT_TRUE(serde_yaml::transcode("[-1, 18446744073709551615, .inf, '2', null, nan, +-5, +7]", ser));
+  ASSERT_EQ(tape.nodes.size(), 9u);
+  EXPECT_EQ(tape.nodes[1].kind, serde::Tape::Node::Int);
+  EXPECT_EQ(tape.nodes[2].kind, serde::Tape::Node::UInt);
+  EXPECT_EQ(tape.nodes[3].kind, serde::Tape::Node::Float);
+  EXPECT_EQ(tape.nodes[4].kind, serde::Tape::Node::Str);
+  EXPECT_EQ(tape.nodes[5].kind, serde::Tape::Node::Null);
+  EXPECT_EQ(tape.nodes[6].kind, serde::Tape::Node::Str);
+  EXPECT_EQ(tape.nodes[7].kind, serde::Tape::Node::Str);
+  EXPECT_EQ(tape.nodes[8].kind, serde::Tape::Node::Int);
+}
+
+TEST(Transcode, Containers)
+{
+  serde::Tape tape;
+  serde::TapeSerializer ser(tape);
+  ASSERT_TRUE(serde_yaml::transcode("base: &base [1, 2]\ncopy: *base\nempty: {}\n", ser));
+  using Type = std::map<std::string, std::vector<int>>;
+  EXPECT_EQ(read_tape<Type>(tape), (Type{{"base", {1, 2}}, {"copy", {1, 2}}, {"empty", {}}}));
+
+  // several documents make a sequence of them
+  tape.clear();
+  ASSERT_TRUE(serde_yaml::transcode("--- [1]\n--- [2, 3]\n", ser));
+  EXPECT_EQ(read_tape<std::vector<std::vector<int>>>(tape), (std::vector<std::vector<int>>{{1}, {2, 3}}));
+
+  tape.clear();
+  ASSERT_TRUE(serde_yaml::transcode_at("hosts:\n  - name: db\n    port: 5432\n", "/hosts/0", ser));
+  EXPECT_EQ(read_tape<Host>(tape).port, 5432);
+}
+
+TEST(Transcode, Yaml)
+{
+  // into the YAML serializer, the output matches serializing the equivalent object
+  const std::map<std::string, std::vector<int>> val = {{"a", {1, 2}}, {"b", {}}};
+  auto ser = serde_yaml::detail::SerializerNew();
+  ASSERT_TRUE(serde_yaml::transcode(serde_yaml::to_string(val).value(), *ser));
+  EXPECT_EQ(serde_yaml::detail::SerializerOutput(ser.get()).value(), serde_yaml::to_string(val).value());
+}
+
+TEST(Transcode, Errors)
+{
+  serde::Tape tape;
+  serde::TapeSerializer ser(tape);
+  auto res = serde_yaml::transcode("a: [1, 2\n", ser);
+  ASSERT_FALSE(res);
+  EXPECT_EQ(res.error().kind, serde::Error::Kind::Syntax);
+  EXPECT_TRUE(tape.nodes.empty());
+
+  // an alias without its anchor fails to resolve after parsing
+  EXPECT_FALSE(serde_yaml::transcode("a: *nowhere\n", ser));
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "serde/std.h"
+#include "serde/serde.h"
+#include "serde/tape.h"
+#include "serde/value.h"
+#include "serde_yaml/serde_yaml.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Dynamic values
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+// known fields plus the rest of the payload passed through as is
+struct Event {
+  std::string type;
+  serde::Value payload;
+};
+} // namespace
+
+template<>
+void serde::serialize(serde::Serializer& ser, const Event& val)
+{
+  ser.serialize_struct_begin();
+  ser.serialize_struct_field("type", val.type);
+  ser.serialize_struct_field("payload", val.payload);
+  ser.serialize_struct_end();
+}
+
+template<>
+void serde::deserialize(serde::Deserializer& de, Event& val)
+{
+  de.deserialize_struct_begin();
+  de.deserialize_struct_field("type", val.type);
+  de.deserialize_struct_field("payload", val.payload);
+  de.deserialize_struct_end();
+}
+
+TEST(Value, FromYaml)
+{
+  const auto val = serde_yaml::from_str<serde::Value>(
+      "name: web\nport: 8080\nload: 0.5\nup: true\nowner: ~\ntags: [a, 'b']\n1: one\n").value();
+  ASSERT_TRUE(val.root().is_map());
+  EXPECT_EQ(val.size(), 7u);
+  EXPECT_EQ(val.find("name")->as_string(), "web");
+  EXPECT_EQ(val.find("port")->kind(), serde::Value::Kind::Int);
+  EXPECT_EQ(val.find("port")->as_int(), 8080);
+  EXPECT_EQ(val.find("load")->as_double(), 0.5);
+  EXPECT_TRUE(val.find("up")->as_bool());
+  EXPECT_TRUE(val.find("owner")->is_null());
+  EXPECT_EQ(val.find("1")->as_string(), "one");
+  EXPECT_FALSE(val.find("missing"));
+
+  const auto tags = *val.find("tags");
+  ASSERT_EQ(tags.size(), 2u);
+  EXPECT_EQ(tags[0].as_string(), "a");
+  EXPECT_EQ(tags[1].as_string(), "b");
+  EXPECT_TRUE(tags[2].is_null());
+
+  std::vector<std::string_view> keys;
+  for (auto entry : val.root())
+    keys.push_back(entry.key());
+  EXPECT_EQ(keys, (std::vector<std::string_view>{"name", "port", "load", "up", "owner", "tags", "1"}));
+}
+
+TEST(Value, Roundtrip)
+{
+  const std::string yaml = "a:\n  - 1\n  - x\n  - {}\nb: null\nc: 18446744073709551615\n";
+  const auto val = serde_yaml::from_str<serde::Value>(std::string(yaml)).value();
+  EXPECT_EQ(serde_yaml::to_string(val).value(), yaml);
+
+  // passthrough: the payload is kept as read and written back
+  const auto event = serde_yaml::from_str<Event>("type: push\npayload:\n  ref: main\n  commits: [1, 2]\n").value();
+  EXPECT_EQ(event.type, "push");
+  EXPECT_EQ(event.payload.find("commits")->size(), 2u);
+  EXPECT_EQ(serde_yaml::to_string(event).value(), "type: push\npayload:\n  ref: main\n  commits:\n    - 1\n    - 2\n");
+}
+
+TEST(Value, Convert)
+{
+  // from and to typed objects through a tape
+  using Type = std::map<std::string, std::vector<std::optional<int>>>;
+  const Type obj = {{"x", {1, std::nullopt}}, {"y", {}}};
+  const auto val = serde::convert<serde::Value>(obj).value();
+  ASSERT_EQ(val.size(), 2u);
+  EXPECT_EQ(val[0].key(), "x");
+  EXPECT_TRUE(val[0][1].is_null());
+  EXPECT_EQ(serde::convert<Type>(val).value(), obj);
+
+  const std::map<int, std::string> numbered = {{-1, "minus"}, {2, "two"}};
+  const auto keys = serde::convert<serde::Value>(numbered).value();
+  EXPECT_EQ(keys.find("-1")->as_string(), "minus");
+  EXPECT_EQ(serde::clone(keys).find("2")->as_string(), "two");
+}
+
+TEST(Value, Build)
+{
+  auto tags = serde::Value::seq().push(serde::Value::from_string("a")).push(serde::Value::from_string("b"));
+  auto limits = serde::Value::map().insert("cpu", serde::Value::from_double(0.5));
+  auto val = serde::Value::map()
+      .insert("name", serde::Value::from_string("web"))
+      .insert("port", serde::Value::from_uint(8080))
+      .insert("offset", serde::Value::from_int(-1))
+      .insert("up", serde::Value::from_bool(true))
+      .insert("owner", serde::Value::null())
+      .insert("tags", tags)
+      .insert("limits", limits);
+  ASSERT_TRUE(val.root().is_map());
+  EXPECT_EQ(val.size(), 7u);
+  EXPECT_EQ(val.find("name")->as_string(), "web");
+  EXPECT_EQ(val.find("port")->as_uint(), 8080u);
+  EXPECT_EQ(val.find("offset")->as_int(), -1);
+  EXPECT_TRUE(val.find("up")->as_bool());
+  EXPECT_TRUE(val.find("owner")->is_null());
+  EXPECT_EQ(val.find("tags")->size(), 2u);
+  EXPECT_EQ((*val.find("tags"))[1].as_string(), "b");
+  EXPECT_EQ(val.find("limits")->find("cpu")->as_double(), 0.5);
+  EXPECT_EQ(val[6].key(), "limits");
+  EXPECT_EQ(serde_yaml::to_string(val).value(),
+            "name: web\nport: 8080\noffset: -1\nup: true\nowner: null\ntags:\n  - a\n  - b\nlimits:\n  cpu: 0.5\n");
+
+  // an empty Value becomes the container, a copy of itself can be appended
+  serde::Value list;
+  list.push(serde::Value()).push(serde::Value::from_bytes("\x01\x02", 2));
+  list.push(list).push(serde::Value::from_string(""));
+  ASSERT_EQ(list.size(), 4u);
+  EXPECT_EQ(list[3].kind(), serde::Value::Kind::Str);
+  EXPECT_TRUE(list[0].is_null());
+  EXPECT_EQ(list[1].as_string(), std::string_view("\x01\x02", 2));
+  EXPECT_EQ(list[2][1].as_string(), std::string_view("\x01\x02", 2));
+  EXPECT_THROW(list.insert("key", serde::Value::null()), std::logic_error);
+
+  const auto obj = serde::convert<std::map<std::string, std::vector<int>>>(
+      serde::Value::map().insert("x", serde::Value::seq().push(serde::Value::from_int(1)))).value();
+  EXPECT_EQ(obj, (std::map<std::string, std::vector<int>>{{"x", {1}}}));
+}